@@ -0,0 +1,581 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "logcplus.h"
+
+/*
+ * logcplus benchmarks. Logger benchmarks (`logger*`) run the whole pipeline: producers log into the bounded queue which
+ * blocks when it's full, so in the steady state the producers throughput is limited by the queue worker (formatting and
+ * writing). Sink benchmarks write the same formatted lines directly to the sink.
+ *
+ * Usage: logcplusBenchmarks [--benchmark_filter=<regex>] [--benchmark_out=<file> --benchmark_out_format=json]
+ */
+namespace dev::marcinromanowski {
+
+    using namespace logcplus;
+
+    inline static LogManager* LOG_MANAGER = LogManager::instance();
+    inline static const std::filesystem::path BENCHMARK_DIRECTORY = std::filesystem::temp_directory_path() / "logcplus-benchmarks";
+    inline static constexpr std::size_t QUEUE_CAPACITY = 8192;
+    inline static constexpr std::size_t SINK_BATCH = 64;
+    // Files written by the sink benchmarks are recreated when they exceed this size.
+    inline static constexpr std::uintmax_t MAX_SINK_FILE_SIZE = 256 * 1024 * 1024;
+
+    inline static std::ofstream NULL_STREAM;
+    inline static std::streambuf* savedStdOut = nullptr;
+
+    void redirectStdOutToNull() {
+        NULL_STREAM.open("/dev/null");
+        savedStdOut = std::cout.rdbuf(NULL_STREAM.rdbuf());
+    }
+
+    void restoreStdOut() {
+        if (savedStdOut) {
+            std::cout.rdbuf(savedStdOut);
+            savedStdOut = nullptr;
+            NULL_STREAM.close();
+        }
+    }
+
+    /**
+     * @brief Sets the logger configuration shared by the logger benchmarks (file mode, bounded lock-free queue, no
+     * rotation, no durability), benchmarks override single settings before `startLogger`.
+     */
+    void resetConfiguration() {
+        std::filesystem::remove_all(BENCHMARK_DIRECTORY);
+        std::filesystem::create_directories(BENCHMARK_DIRECTORY);
+
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->disableCrashHandler();
+        LOG_MANAGER->setLogDirectory(BENCHMARK_DIRECTORY);
+        LOG_MANAGER->setLogLevel(Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(Logger::LogMode::File);
+        LOG_MANAGER->setFormattingMode(Logger::FormattingMode::Deferred);
+        LOG_MANAGER->setTimestampPrecision(TimestampCache::Precision::Seconds);
+        LOG_MANAGER->setQueueType(Logger::QueueType::LockFree, QUEUE_CAPACITY);
+        LOG_MANAGER->setOverflowPolicy(Logger::OverflowPolicy::Block);
+        LOG_MANAGER->setFlushPolicy(Logger::FlushPolicy::EveryBatch);
+        LOG_MANAGER->setMaxFileSize(1, filesize_t::SizeUnit::GiB);
+        LOG_MANAGER->setCompression(Logger::Compression::None);
+        LOG_MANAGER->setFileBackend(Logger::FileBackend::Write);
+        LOG_MANAGER->setSyncPolicy(Logger::SyncPolicy::None);
+        LOG_MANAGER->setSharedMemoryRing(false);
+        LOG_MANAGER->setBacktraceSize(0);
+    }
+
+    void startLogger() {
+        LOG_MANAGER->initialize();
+    }
+
+    /**
+     * @brief Writes all pending messages, closes the log file and restores the default configuration.
+     */
+    void stopLogger(const benchmark::State&) {
+        LOG_MANAGER->shutdown();
+        restoreStdOut();
+        resetConfiguration();
+        LOG_MANAGER->setLogMode(Logger::LogMode::Console);
+        LOG_MANAGER->setQueueType(Logger::QueueType::Locked, 0);
+        std::filesystem::remove_all(BENCHMARK_DIRECTORY);
+    }
+
+    std::size_t logFilesCount() {
+        std::size_t count = 0;
+        for (const auto& entry: std::filesystem::directory_iterator(BENCHMARK_DIRECTORY)) {
+            count += entry.is_regular_file() ? 1 : 0;
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Formatted log lines written by the sink benchmarks.
+     */
+    class SinkLines {
+        std::vector<std::string> lines_;
+        std::vector<struct iovec> spans_;
+        std::string text_; // All lines in a single buffer.
+
+    public:
+        SinkLines() {
+            DefaultFormatter formatter;
+            LogRecord record;
+            for (std::size_t i = 0; i < SINK_BATCH; i++) {
+                record.clear();
+                record.deferred = true;
+                record.level = LogLevel::Info;
+                record.timestamp = std::chrono::system_clock::now();
+                LogArguments::pack(record, "Request", static_cast<int>(i), "processed in", 0.25 * static_cast<double>(i), "ms");
+
+                std::string line;
+                formatter.format(record, line);
+                line.push_back('\n');
+                text_.append(line);
+                lines_.push_back(std::move(line));
+            }
+
+            spans_.resize(lines_.size());
+        }
+
+        /**
+         * @brief Spans of all lines (sinks may modify them, so they are refreshed on every call).
+         */
+        struct iovec* spans() {
+            for (std::size_t i = 0; i < lines_.size(); i++) {
+                spans_[i].iov_base = lines_[i].data();
+                spans_[i].iov_len = lines_[i].size();
+            }
+
+            return spans_.data();
+        }
+
+        const std::vector<std::string>& lines() const {
+            return lines_;
+        }
+
+        std::size_t count() const {
+            return lines_.size();
+        }
+
+        const std::string& text() const {
+            return text_;
+        }
+
+        std::size_t bytes() const {
+            return text_.size();
+        }
+    };
+
+    // --- Caller thread ---------------------------------------------------------------------------------------------
+
+    void setupInfoCall(const benchmark::State& state) {
+        resetConfiguration();
+        LOG_MANAGER->setFormattingMode(state.range(0) == 0 ? Logger::FormattingMode::Eager : Logger::FormattingMode::Deferred);
+        startLogger();
+    }
+
+    /*
+     * Latency of a single `info()` call (eager or deferred formatting), including the backpressure of the worker.
+     */
+    void infoCallLatency(benchmark::State& state) {
+        Logger* logger = LogManager::getLogger();
+        int i = 0;
+        for (auto _: state) {
+            logger->info("Request", i++, "processed in", 0.25, "ms");
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+        state.SetLabel(state.range(0) == 0 ? "eager" : "deferred");
+    }
+
+    BENCHMARK(infoCallLatency)->Arg(0)->Arg(1)->Setup(setupInfoCall)->Teardown(stopLogger);
+
+    void setupDisabledLevel(const benchmark::State&) {
+        resetConfiguration();
+        startLogger();
+    }
+
+    std::string expensiveArgument(const int _i) {
+        return "payload " + std::to_string(_i);
+    }
+
+    /*
+     * Cost of the message below the log level: direct call (arguments are evaluated) vs LOGCPLUS_DEBUG macro (arguments
+     * are not evaluated). Calls below LOGCPLUS_ACTIVE_LEVEL compile to nothing.
+     */
+    void disabledLevelCall(benchmark::State& state) {
+        Logger* logger = LogManager::getLogger();
+        int i = 0;
+        if (state.range(0) == 0) {
+            for (auto _: state) {
+                logger->debug("Request", expensiveArgument(i++));
+            }
+        } else {
+            for (auto _: state) {
+                LOGCPLUS_DEBUG(logger, "Request", expensiveArgument(i++));
+            }
+        }
+
+        benchmark::DoNotOptimize(i);
+        state.SetLabel(state.range(0) == 0 ? "call" : "macro");
+    }
+
+    BENCHMARK(disabledLevelCall)->Arg(0)->Arg(1)->Setup(setupDisabledLevel)->Teardown(stopLogger);
+
+    /*
+     * Argument type mixes formatted by the caller (eager formatting).
+     */
+    template<typename ...Args>
+    void concatenateLogArguments(benchmark::State& state, const Args& ...args) {
+        std::string output;
+        for (auto _: state) {
+            output.clear();
+            LogArguments::concatenate(output, args...);
+            benchmark::DoNotOptimize(output.data());
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * output.size()));
+    }
+
+    BENCHMARK_CAPTURE(concatenateLogArguments, strings, "Request", "from", "127.0.0.1", "processed");
+    BENCHMARK_CAPTURE(concatenateLogArguments, integers, 42, -7, 1024ULL, 65535L);
+    BENCHMARK_CAPTURE(concatenateLogArguments, doubles, 0.25, 3.14159, -1.5e10, 2.0);
+    BENCHMARK_CAPTURE(concatenateLogArguments, mixed, "Request", 42, "processed in", 0.25, "ms", std::string("status"), 200U);
+
+    /*
+     * Argument type mixes packed by the caller (deferred formatting) and formatted later by the worker.
+     */
+    template<typename ...Args>
+    void packLogArguments(benchmark::State& state, const Args& ...args) {
+        LogRecord record;
+        std::string output;
+        for (auto _: state) {
+            record.clear();
+            LogArguments::pack(record, args...);
+            output.clear();
+            LogArguments::format(record.payload(), output);
+            benchmark::DoNotOptimize(output.data());
+        }
+    }
+
+    BENCHMARK_CAPTURE(packLogArguments, strings, "Request", "from", "127.0.0.1", "processed");
+    BENCHMARK_CAPTURE(packLogArguments, integers, 42, -7, 1024ULL, 65535L);
+    BENCHMARK_CAPTURE(packLogArguments, doubles, 0.25, 3.14159, -1.5e10, 2.0);
+    BENCHMARK_CAPTURE(packLogArguments, mixed, "Request", 42, "processed in", 0.25, "ms", std::string("status"), 200U);
+
+    /*
+     * Timestamp rendering: the cached prefix (TimestampCache) vs std::put_time of every timestamp.
+     */
+    void timestampCache(benchmark::State& state) {
+        TimestampCache cache(static_cast<TimestampCache::Precision>(state.range(0)));
+        for (auto _: state) {
+            benchmark::DoNotOptimize(cache.format(std::chrono::system_clock::now()).data());
+        }
+    }
+
+    BENCHMARK(timestampCache)->DenseRange(0, 2)->ArgName("precision");
+
+    void timestampPutTime(benchmark::State& state) {
+        for (auto _: state) {
+            std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            std::tm tm{};
+            localtime_r(&time, &tm);
+
+            std::ostringstream stream;
+            stream << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+            benchmark::DoNotOptimize(stream.str().data());
+        }
+    }
+
+    BENCHMARK(timestampPutTime);
+
+    /*
+     * Text vs binary (BinaryFormatter) formatting of the deferred record.
+     */
+    void formatRecord(benchmark::State& state) {
+        std::unique_ptr<LogFormatter> formatter;
+        if (state.range(0) == 0) {
+            formatter = std::make_unique<DefaultFormatter>();
+        } else {
+            formatter = std::make_unique<BinaryFormatter>();
+        }
+
+        LogRecord record;
+        record.deferred = true;
+        record.level = LogLevel::Info;
+        record.timestamp = std::chrono::system_clock::now();
+        LogArguments::pack(record, "Request", 42, "processed in", 0.25, "ms");
+
+        std::string output;
+        std::size_t bytes = 0;
+        for (auto _: state) {
+            output.clear();
+            formatter->format(record, output);
+            bytes += output.size();
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+        state.SetLabel(state.range(0) == 0 ? "text" : "binary");
+    }
+
+    BENCHMARK(formatRecord)->Arg(0)->Arg(1);
+
+    // --- Queues ----------------------------------------------------------------------------------------------------
+
+    inline static std::unique_ptr<MessageQueue<std::uint64_t>> benchmarkQueue;
+    inline static std::thread queueConsumer;
+    inline static std::atomic<bool> consume{false};
+
+    void setupQueue(const benchmark::State& state) {
+        if (state.range(0) == 0) {
+            benchmarkQueue = std::make_unique<ConcurrentQueue<std::uint64_t>>(QUEUE_CAPACITY);
+        } else {
+            benchmarkQueue = std::make_unique<RingBuffer<std::uint64_t>>(QUEUE_CAPACITY);
+        }
+
+        consume.store(true, std::memory_order_release);
+        queueConsumer = std::thread([]() {
+            std::vector<std::uint64_t> items;
+            while (consume.load(std::memory_order_acquire)) {
+                items.clear();
+                if (benchmarkQueue->tryDequeueBulk(items, 1024) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    void teardownQueue(const benchmark::State&) {
+        consume.store(false, std::memory_order_release);
+        queueConsumer.join();
+        benchmarkQueue.reset();
+    }
+
+    /*
+     * Producers contention on the bounded queue (locked vs lock-free) drained by a single consumer.
+     */
+    void queueContention(benchmark::State& state) {
+        std::uint64_t item = 0;
+        for (auto _: state) {
+            benchmarkQueue->enqueue(item++);
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+        state.SetLabel(state.range(0) == 0 ? "locked" : "lock-free");
+    }
+
+    BENCHMARK(queueContention)->Arg(0)->Arg(1)->ThreadRange(1, 64)->UseRealTime()->Setup(setupQueue)->Teardown(teardownQueue);
+
+    // --- Logger pipeline -------------------------------------------------------------------------------------------
+
+    void logMessages(benchmark::State& state) {
+        Logger* logger = LogManager::getLogger();
+        int i = 0;
+        for (auto _: state) {
+            logger->info("Request", i++, "processed in", 0.25, "ms");
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    void setupThroughput(const benchmark::State& state) {
+        resetConfiguration();
+        LOG_MANAGER->setQueueType(static_cast<Logger::QueueType>(state.range(0)), QUEUE_CAPACITY);
+        startLogger();
+    }
+
+    /*
+     * Multi-thread logging throughput for every queue type (0 - Locked, 1 - LockFree, 2 - PerThread).
+     */
+    void loggerThroughput(benchmark::State& state) {
+        logMessages(state);
+    }
+
+    BENCHMARK(loggerThroughput)->DenseRange(0, 2)->ArgName("queue")->ThreadRange(1, 64)->UseRealTime()
+        ->Setup(setupThroughput)->Teardown(stopLogger);
+
+    void setupSinkMode(const benchmark::State& state) {
+        resetConfiguration();
+        if (state.range(0) == 0) {
+            redirectStdOutToNull();
+            LOG_MANAGER->setLogMode(Logger::LogMode::Console);
+        }
+        startLogger();
+    }
+
+    /*
+     * Console (std::cout redirected to /dev/null) vs file logging.
+     */
+    void loggerSinkMode(benchmark::State& state) {
+        logMessages(state);
+        state.SetLabel(state.range(0) == 0 ? "console" : "file");
+    }
+
+    BENCHMARK(loggerSinkMode)->Arg(0)->Arg(1)->UseRealTime()->Setup(setupSinkMode)->Teardown(stopLogger);
+
+    void setupFileBackend(const benchmark::State& state) {
+        resetConfiguration();
+        LOG_MANAGER->setFileBackend(static_cast<Logger::FileBackend>(state.range(0)));
+        startLogger();
+    }
+
+    /*
+     * File backends (0 - Write, 1 - Mmap, 2 - IoUring).
+     */
+    void loggerFileBackend(benchmark::State& state) {
+        logMessages(state);
+    }
+
+    BENCHMARK(loggerFileBackend)->DenseRange(0, 2)->ArgName("backend")->UseRealTime()
+        ->Setup(setupFileBackend)->Teardown(stopLogger);
+
+    void setupRotation(const benchmark::State& state) {
+        resetConfiguration();
+        LOG_MANAGER->setMaxFileSize(static_cast<std::uintmax_t>(state.range(0)), filesize_t::SizeUnit::KiB);
+        startLogger();
+    }
+
+    /*
+     * Logging with the file rotation (max file size in KiB) under the multi-thread load.
+     */
+    void loggerRotation(benchmark::State& state) {
+        logMessages(state);
+        if (state.thread_index() == 0) {
+            state.counters["files"] = static_cast<double>(logFilesCount());
+        }
+    }
+
+    BENCHMARK(loggerRotation)->Arg(256)->Arg(4096)->Arg(1024 * 1024)->ArgName("maxKiB")->Threads(1)->Threads(8)->UseRealTime()
+        ->Setup(setupRotation)->Teardown(stopLogger);
+
+    void setupSyncPolicy(const benchmark::State& state) {
+        resetConfiguration();
+        LOG_MANAGER->setSyncPolicy(static_cast<Logger::SyncPolicy>(state.range(0)));
+        LOG_MANAGER->setSyncInterval(std::chrono::milliseconds(100));
+        startLogger();
+    }
+
+    /*
+     * Sync policies (0 - None, 1 - Periodic every 100 ms, 2 - OnError, 3 - EveryBatch), every 100th message is an error.
+     */
+    void loggerSyncPolicy(benchmark::State& state) {
+        Logger* logger = LogManager::getLogger();
+        int i = 0;
+        for (auto _: state) {
+            if (++i % 100 == 0) {
+                logger->error("Request", i, "failed");
+            } else {
+                logger->info("Request", i, "processed in", 0.25, "ms");
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    BENCHMARK(loggerSyncPolicy)->DenseRange(0, 3)->ArgName("policy")->UseRealTime()
+        ->Setup(setupSyncPolicy)->Teardown(stopLogger);
+
+    // --- Sinks -----------------------------------------------------------------------------------------------------
+
+    /*
+     * Writes the batch of formatted lines to the file sink (0 - write(2), 1 - memory mapped, 2 - io_uring) as a single
+     * buffer, like the logger does for the log file.
+     */
+    void fileSinkWrite(benchmark::State& state) {
+        std::filesystem::create_directories(BENCHMARK_DIRECTORY);
+        std::string path = BENCHMARK_DIRECTORY / "fileSink.log";
+        std::filesystem::remove(path);
+
+        FileSink sink;
+        sink.setSegmentSize(state.range(0) == 1 ? FileSink::DEFAULT_SEGMENT_SIZE : 0);
+        sink.setAsyncWrites(state.range(0) == 2);
+        sink.open(path);
+
+        SinkLines lines;
+        std::string buffer;
+        for (auto _: state) {
+            buffer.assign(lines.text());
+            sink.write(buffer);
+
+            if (sink.size() > MAX_SINK_FILE_SIZE) {
+                state.PauseTiming();
+                std::filesystem::remove(path);
+                sink.open(path);
+                state.ResumeTiming();
+            }
+        }
+
+        sink.close();
+        std::filesystem::remove_all(BENCHMARK_DIRECTORY);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * lines.bytes()));
+    }
+
+    BENCHMARK(fileSinkWrite)->DenseRange(0, 2)->ArgName("backend")->UseRealTime();
+
+    /*
+     * Baseline: the same lines written with std::ofstream (flushed after every batch like the sinks).
+     */
+    void ofstreamWrite(benchmark::State& state) {
+        std::filesystem::create_directories(BENCHMARK_DIRECTORY);
+        std::string path = BENCHMARK_DIRECTORY / "ofstream.log";
+
+        std::ofstream file(path, std::ios::trunc);
+        std::uintmax_t written = 0;
+        SinkLines lines;
+        for (auto _: state) {
+            for (const auto& line: lines.lines()) {
+                file << line;
+            }
+            file.flush();
+
+            written += lines.bytes();
+            if (written > MAX_SINK_FILE_SIZE) {
+                state.PauseTiming();
+                file.close();
+                file.open(path, std::ios::trunc);
+                written = 0;
+                state.ResumeTiming();
+            }
+        }
+
+        file.close();
+        std::filesystem::remove_all(BENCHMARK_DIRECTORY);
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * lines.bytes()));
+    }
+
+    BENCHMARK(ofstreamWrite)->UseRealTime();
+
+    /*
+     * Writes formatted lines to the console sink (std::cout redirected to /dev/null).
+     */
+    void consoleSinkWrite(benchmark::State& state) {
+        redirectStdOutToNull();
+
+        ConsoleSink sink;
+        SinkLines lines;
+        for (auto _: state) {
+            sink.write(lines.spans(), lines.count());
+        }
+
+        restoreStdOut();
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * lines.bytes()));
+    }
+
+    BENCHMARK(consoleSinkWrite)->UseRealTime();
+
+#ifdef LOGCPLUS_WITH_ZLIB
+    /*
+     * Gzip sink block size (KiB): CPU time per written byte and the compression ratio (compressed / written bytes).
+     */
+    void gzipSinkWrite(benchmark::State& state) {
+        std::filesystem::create_directories(BENCHMARK_DIRECTORY);
+        std::string path = BENCHMARK_DIRECTORY / "gzipSink.log.gz";
+        std::filesystem::remove(path);
+
+        std::uintmax_t written = 0;
+        SinkLines lines;
+        {
+            GzipFileSink sink(static_cast<std::size_t>(state.range(0)) * 1024);
+            sink.open(path);
+            for (auto _: state) {
+                sink.write(lines.spans(), lines.count());
+                written += lines.bytes();
+            }
+        }
+
+        state.counters["ratio"] = written > 0 ? static_cast<double>(std::filesystem::file_size(path)) / static_cast<double>(written) : 0.0;
+        std::filesystem::remove_all(BENCHMARK_DIRECTORY);
+        state.SetBytesProcessed(static_cast<std::int64_t>(written));
+    }
+
+    BENCHMARK(gzipSinkWrite)->RangeMultiplier(4)->Range(4, 1024)->ArgName("blockKiB");
+#endif
+
+}
+
+BENCHMARK_MAIN();
@@ -2,6 +2,23 @@
 #define LOGCPLUS_LOGCPLUS_H
 
 #include <queue>
+#include <vector>
+#include <array>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <csignal>
+#include <iomanip>
+#include <sstream>
+#include <limits>
+#include <cstring>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+#include <type_traits>
 #include <cassert>
 #include <any>
 #include <fstream>
@@ -12,9 +29,57 @@
 #include <regex>
 #include <mutex>
 #include <optional>
+#include <map>
 #include <condition_variable>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+
+#ifdef LOGCPLUS_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+// Asynchronous file writes (see AsyncFileWriter), the kernel support is checked at runtime.
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define LOGCPLUS_HAS_IO_URING
+#endif
+
+#define LOG_FILE_FORMAT "\\d{4}[-]\\d{2}[-]\\d{2}[.]log[.]\\d+([.]gz)?"
 
-#define LOG_FILE_FORMAT "\\d{4}[-]\\d{2}[-]\\d{2}.log.\\d"
+/*
+ * Compile time minimum log level: 0 - Debug, 1 - Info, 2 - Warn, 3 - Error, 4 - Fatal. Log calls below this level
+ * compile to nothing (see LOGCPLUS_DEBUG, LOGCPLUS_INFO... macros at the end of the file).
+ */
+#ifndef LOGCPLUS_ACTIVE_LEVEL
+#define LOGCPLUS_ACTIVE_LEVEL 0
+#endif
+
+/*
+ * Number of preallocated log records and 4 KiB chunks for long messages. When all records are in use (e.g. the queue
+ * worker is behind), the new records are allocated on the heap.
+ */
+#ifndef LOGCPLUS_RECORD_POOL_SIZE
+#define LOGCPLUS_RECORD_POOL_SIZE 4096
+#endif
+
+#ifndef LOGCPLUS_SLAB_CHUNKS
+#define LOGCPLUS_SLAB_CHUNKS 256
+#endif
+
+/*
+ * Max time (milliseconds) the crash handler waits for the queue worker to write pending messages.
+ */
+#ifndef LOGCPLUS_CRASH_FLUSH_TIMEOUT
+#define LOGCPLUS_CRASH_FLUSH_TIMEOUT 2000
+#endif
 
 inline static std::string const& to_string(std::string const& _str) { return _str; }
 
@@ -38,6 +103,67 @@ inline static std::string const& to_string(std::string const& _str) { return _st
  *  row - the message levels that will be printed by the logger
  */
 namespace dev::marcinromanowski::logcplus {
+    /**
+     * @brief MessageQueue is a common interface for the logger message queues.
+     */
+    template<class T>
+    class MessageQueue {
+    public:
+        virtual ~MessageQueue() = default;
+
+        /**
+         * @brief Enqueue item into a queue. Waits for a free space if the queue is bounded.
+         * @param _queueItem Item to insert into the queue.
+         */
+        virtual void enqueue(T _queueItem) = 0;
+
+        /**
+         * @brief Tries to enqueue item into a queue without waiting.
+         * @param _queueItem Item to insert into the queue (moved only on success).
+         * @return True if item was inserted, false if the queue is full.
+         */
+        virtual bool tryEnqueue(T&& _queueItem) = 0;
+
+        /**
+         * @brief Tries to remove item (dequeue) from the queue without waiting.
+         * @param _queueItem Output head item from the queue.
+         * @return True if item was removed, false if the queue is empty.
+         */
+        virtual bool tryDequeue(T& _queueItem) = 0;
+
+        /**
+         * @brief Removes up to `_maxItems` items from the queue without waiting.
+         * @param _queueItems Output container, removed items are appended at the end.
+         * @param _maxItems Max number of items to remove.
+         * @return Number of removed items.
+         */
+        virtual std::size_t tryDequeueBulk(std::vector<T>& _queueItems, std::size_t _maxItems) = 0;
+
+        /**
+         * @brief Removed all items from the queue.
+         */
+        virtual void clear() = 0;
+
+        /**
+         * @brief Current queue length.
+         * @return Size of the queue.
+         */
+        virtual std::uint64_t length() const = 0;
+
+        /**
+         * @brief Checks that queue is currently empty.
+         * @return Empty => true, otherwise false.
+         */
+        virtual bool empty() const = 0;
+
+        /**
+         * @brief Checks if items can be removed by many threads at once (e.g. producers dropping the oldest items).
+         */
+        virtual bool isMultiConsumer() const {
+            return true;
+        }
+    };
+
     /**
      * @brief ConcurrentQueue is a simple thread safety wrapper around queue.
      *
@@ -46,12 +172,21 @@ namespace dev::marcinromanowski::logcplus {
      *  https://en.cppreference.com/w/cpp/thread/condition_variable
      */
     template<class T>
-    class ConcurrentQueue {
+    class ConcurrentQueue : public MessageQueue<T> {
         mutable std::mutex mutex_;
         std::queue<T> queueContainer_;
         std::condition_variable conditionVariable_;
+        std::condition_variable notFullConditionVariable_;
+        const std::size_t capacity_; // Max number of items, 0 - unbounded.
 
     public:
+        /**
+         * @param _capacity Max number of items in the queue, 0 - unbounded queue.
+         */
+        explicit ConcurrentQueue(const std::size_t _capacity = 0) : capacity_(_capacity) {
+
+        }
+
         /**
          * @brief Get current head item without remove it.
          * @return Head value stored in a queue.
@@ -65,10 +200,32 @@ namespace dev::marcinromanowski::logcplus {
          * @brief Enqueue item into a queue.
          * @param _queueItem Item to insert into the queue.
          */
-        void enqueue(T _queueItem) {
+        void enqueue(T _queueItem) override {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            // If queue is bounded and full we need to wait till a element is removed.
+            notFullConditionVariable_.wait(lock, [&] {
+                return !isFull();
+            });
+
+            queueContainer_.push(std::move(_queueItem));
+            conditionVariable_.notify_one();
+        }
+
+        /**
+         * @brief Enqueue item into a queue if there is a free space (unbounded queue always succeeds).
+         * @param _queueItem Item to insert into the queue.
+         */
+        bool tryEnqueue(T&& _queueItem) override {
             std::lock_guard<std::mutex> lock(mutex_);
-            queueContainer_.push(_queueItem);
+            if (isFull()) {
+                return false;
+            }
+
+            queueContainer_.push(std::move(_queueItem));
             conditionVariable_.notify_one();
+
+            return true;
         }
 
         /**
@@ -83,27 +240,80 @@ namespace dev::marcinromanowski::logcplus {
                 return !queueContainer_.empty();
             });
 
-            T queueItem = queueContainer_.front();
+            T queueItem = std::move(queueContainer_.front());
             queueContainer_.pop();
+            notFullConditionVariable_.notify_one();
 
             return queueItem;
         }
 
+        /**
+         * @brief Remove item (dequeue) from the queue if any is available.
+         * @param _queueItem Output head item from the queue.
+         * @return True if item was removed, otherwise false.
+         */
+        bool tryDequeue(T& _queueItem) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queueContainer_.empty()) {
+                return false;
+            }
+
+            _queueItem = std::move(queueContainer_.front());
+            queueContainer_.pop();
+            notFullConditionVariable_.notify_one();
+
+            return true;
+        }
+
+        /**
+         * @brief Removes up to `_maxItems` items from the queue. If all pending items fit, the whole container is
+         * swapped out under a single lock.
+         */
+        std::size_t tryDequeueBulk(std::vector<T>& _queueItems, std::size_t _maxItems) override {
+            std::queue<T> pendingItems;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (_maxItems < queueContainer_.size()) {
+                    for (std::size_t i = 0; i < _maxItems; i++) {
+                        _queueItems.push_back(std::move(queueContainer_.front()));
+                        queueContainer_.pop();
+                    }
+
+                    notFullConditionVariable_.notify_all();
+                    return _maxItems;
+                }
+
+                pendingItems.swap(queueContainer_);
+                notFullConditionVariable_.notify_all();
+            }
+
+            std::size_t count = pendingItems.size();
+            while (!pendingItems.empty()) {
+                _queueItems.push_back(std::move(pendingItems.front()));
+                pendingItems.pop();
+            }
+
+            return count;
+        }
+
         /**
          * @brief Removed all items from the queue.
          */
-        void clear() {
+        void clear() override {
             std::unique_lock<std::mutex> lock(mutex_);
             while (!queueContainer_.empty()) {
                 queueContainer_.pop();
             }
+
+            notFullConditionVariable_.notify_all();
         }
 
         /**
          * @brief Current queue length.
          * @return Size of the queue.
          */
-        std::uint64_t length() const {
+        std::uint64_t length() const override {
+            std::lock_guard<std::mutex> lock(mutex_);
             return queueContainer_.size();
         }
 
@@ -111,1253 +321,5583 @@ namespace dev::marcinromanowski::logcplus {
          * @brief Checks that queue is currently empty.
          * @return Empty => true, otherwise false.
          */
-        bool empty() const {
+        bool empty() const override {
+            std::lock_guard<std::mutex> lock(mutex_);
             return queueContainer_.empty();
         }
+
+    private:
+        bool isFull() const {
+            return capacity_ > 0 && queueContainer_.size() >= capacity_;
+        }
     };
 
     /**
-     * @brief The Date class is a simple wrapper around `tm struct` from the ctime library.
+     * @brief
+     * RingBuffer is a bounded lock-free multi-producer queue. Every slot has its own sequence number, so producers only
+     * compete for the tail index and never take a lock. Head and tail indexes live on separate cache lines.
+     *
+     * Reference:
+     *  https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
      */
-    class Date {
-        int day_; // Day of month [1; 31]
-        int month_; // Month of year [0, 11]
-        int year_; // Year since 1900
+    template<class T>
+    class RingBuffer : public MessageQueue<T> {
+        static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+        struct alignas(CACHE_LINE_SIZE) Slot {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> slots_;
+        std::size_t mask_;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_; // Consumer position.
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_; // Producers position.
+        char padding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
 
     public:
         /**
-         * @brief The Time struct represent time in format h:m:s.
+         * @param _capacity Max number of items in the queue, rounded up to the power of two.
          */
-        struct Time {
-            Time(const int _hour = 0, const int _minute = 0, const int _second = 0) {
-                this->hour = _hour;
-                this->minute = _minute;
-                this->second = _second;
+        explicit RingBuffer(std::size_t _capacity) {
+            std::size_t capacity = 2;
+            while (capacity < _capacity) {
+                capacity <<= 1;
             }
 
-            friend bool operator==(const Time& _lhs, const Time& _rhs) {
-                return (_lhs.hour == _rhs.hour && _lhs.minute == _rhs.minute && _lhs.second == _rhs.second);
+            slots_ = std::make_unique<Slot[]>(capacity);
+            mask_ = capacity - 1;
+            for (std::size_t i = 0; i < capacity; i++) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
             }
 
-            friend bool operator!=(const Time& _lhs, const Time& _rhs) {
-                return !(_lhs == _rhs);
-            }
+            head_.store(0, std::memory_order_relaxed);
+            tail_.store(0, std::memory_order_relaxed);
+        }
 
-            friend bool operator<(const Time& _lhs, const Time& _rhs) {
-                return (_lhs.hour < _rhs.hour && _lhs.minute < _rhs.minute && _lhs.second < _rhs.second);
-            }
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
 
-            friend bool operator>(const Time& _lhs, const Time& _rhs) {
-                return (_lhs < _rhs);
-            }
+        /**
+         * @brief Max number of items in the queue.
+         */
+        std::size_t capacity() const {
+            return mask_ + 1;
+        }
 
-            friend bool operator<=(const Time& _lhs, const Time& _rhs) {
-                return !(_lhs > _rhs);
+        /**
+         * @brief Enqueue item into a queue. Yields the current thread while the queue is full.
+         * @param _queueItem Item to insert into the queue.
+         */
+        void enqueue(T _queueItem) override {
+            while (!tryEnqueue(std::move(_queueItem))) {
+                std::this_thread::yield();
             }
+        }
 
-            friend bool operator>=(const Time& _lhs, const Time& _rhs) {
-                return !(_lhs < _rhs);
-            }
+        bool tryEnqueue(T&& _queueItem) override {
+            Slot* slot;
+            std::size_t position = tail_.load(std::memory_order_relaxed);
 
-            std::string toString() const {
-                return addTrailingZero(this->hour) + ":" + addTrailingZero(this->minute) + ":" + addTrailingZero(this->second);
-            }
+            for (;;) {
+                slot = &slots_[position & mask_];
+                std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
 
-            static std::string toString(const Time _time) {
-                return addTrailingZero(_time.hour) + ":" + addTrailingZero(_time.minute) + ":" + addTrailingZero(_time.second);
+                if (difference == 0) {
+                    if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    // Slot was not released by the consumer yet - queue is full.
+                    return false;
+                } else {
+                    position = tail_.load(std::memory_order_relaxed);
+                }
             }
 
-            int hour; // Hours of day [0; 23]
-            int minute; // Minutes of hour [0; 59]
-            int second; // Seconds of minutes [0; 60]
+            slot->value = std::move(_queueItem);
+            slot->sequence.store(position + 1, std::memory_order_release);
 
-        private:
-            static std::string addTrailingZero(int _value) {
-                return _value >= 0 && _value <= 9 ? "0" + std::to_string(_value) : std::to_string(_value);
-            }
-        } time_; // Hour, minute and second
+            return true;
+        }
 
-        Date() : day_(1), month_(0), year_(1900), time_(0, 0, 0) {
+        bool tryDequeue(T& _queueItem) override {
+            Slot* slot;
+            std::size_t position = head_.load(std::memory_order_relaxed);
 
-        }
+            for (;;) {
+                slot = &slots_[position & mask_];
+                std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
 
-        int hour() const {
-            return time_.hour;
-        }
+                if (difference == 0) {
+                    if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    // Slot was not published by the producer yet - queue is empty.
+                    return false;
+                } else {
+                    position = head_.load(std::memory_order_relaxed);
+                }
+            }
 
-        int minute() const {
-            return time_.minute;
-        }
+            _queueItem = std::move(slot->value);
+            slot->sequence.store(position + mask_ + 1, std::memory_order_release);
 
-        int second() const {
-            return time_.second;
+            return true;
         }
 
-        Time time() const {
-            return time_;
-        }
+        std::size_t tryDequeueBulk(std::vector<T>& _queueItems, std::size_t _maxItems) override {
+            std::size_t count = 0;
+            T queueItem;
 
-        int day() const {
-            return day_;
-        }
+            while (count < _maxItems && tryDequeue(queueItem)) {
+                _queueItems.push_back(std::move(queueItem));
+                count++;
+            }
 
-        int month() const {
-            return month_;
+            return count;
         }
 
-        int year() const {
-            return year_;
+        void clear() override {
+            T queueItem;
+            while (tryDequeue(queueItem)) {}
         }
 
-        Date& setSeconds(int _seconds) {
-            assert(_seconds >= 0 && _seconds <= 59);
+        std::uint64_t length() const override {
+            std::size_t tail = tail_.load(std::memory_order_acquire);
+            std::size_t head = head_.load(std::memory_order_acquire);
 
-            time_.second = _seconds;
-            return *this;
+            return tail > head ? tail - head : 0;
         }
 
-        Date& setMinutes(int _minutes) {
-            assert(_minutes >= 0 && _minutes <= 59);
-
-            time_.minute = _minutes;
-            return *this;
+        bool empty() const override {
+            return length() == 0;
         }
+    };
 
-        Date& setHour(int _hour) {
-            assert(_hour >= 0 && _hour <= 23);
+    /**
+     * @brief
+     * SpscRingBuffer is a bounded lock-free single-producer single-consumer queue. The producer and the consumer write
+     * only their own index (each on a separate cache line) and cache the other side index to avoid cache line transfers.
+     */
+    template<class T>
+    class SpscRingBuffer {
+        static constexpr std::size_t CACHE_LINE_SIZE = 64;
 
-            time_.hour = _hour;
-            return *this;
-        }
+        std::unique_ptr<T[]> slots_;
+        std::size_t mask_;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_; // Consumer position.
+        std::size_t cachedTail_; // Consumer copy of the producer position.
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_; // Producer position.
+        std::size_t cachedHead_; // Producer copy of the consumer position.
+        char padding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
 
-        Date& setDay(int _day) {
-            assert(_day >= 1 && _day <= 31);
+    public:
+        /**
+         * @param _capacity Max number of items in the queue, rounded up to the power of two.
+         */
+        explicit SpscRingBuffer(std::size_t _capacity) : head_(0), cachedTail_(0), tail_(0), cachedHead_(0) {
+            std::size_t capacity = 2;
+            while (capacity < _capacity) {
+                capacity <<= 1;
+            }
 
-            day_ = _day;
-            return *this;
+            slots_ = std::make_unique<T[]>(capacity);
+            mask_ = capacity - 1;
         }
 
-        Date& setMonth(int _month) {
-            assert(_month >= 1 && _month <= 12);
+        SpscRingBuffer(const SpscRingBuffer&) = delete;
+        SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
 
-            month_ = _month;
-            return *this;
-        }
+        /**
+         * @brief Inserts item (producer thread only).
+         * @return True if item was inserted (moved), false if the queue is full.
+         */
+        bool tryEnqueue(T&& _queueItem) {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cachedHead_ > mask_) {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail - cachedHead_ > mask_) {
+                    return false;
+                }
+            }
 
-        Date& setYear(int _year) {
-            assert(_year > 0);
+            slots_[tail & mask_] = std::move(_queueItem);
+            tail_.store(tail + 1, std::memory_order_release);
 
-            year_ = _year;
-            return *this;
+            return true;
         }
 
         /**
-         * @brief Returns current date.
-         * @return Hour, minute, second, day, month and year.
+         * @brief Returns head item without removing it (consumer thread only).
+         * @return Pointer to the head item or nullptr if the queue is empty.
          */
-        static Date now() {
-            std::time_t now = std::time(0);
-            std::tm* localTime = std::localtime(&now);
-
-            Date date;
-            date.time_.second = localTime->tm_sec;
-            date.time_.minute = localTime->tm_min;
-            date.time_.hour = localTime->tm_hour;
-            date.day_ = localTime->tm_mday;
-            date.month_ = localTime->tm_mon + 1;
-            date.year_ = localTime->tm_year + 1900;
+        T* front() {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cachedTail_) {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head == cachedTail_) {
+                    return nullptr;
+                }
+            }
 
-            return date;
+            return &slots_[head & mask_];
         }
 
         /**
-         * @brief Returns current time.
-         * @return Hour, minute and second.
+         * @brief Removes head item returned by `front` (consumer thread only).
          */
-        static Time currentTime() {
-            Date currentDate = now();
-            return currentDate.time();
+        void pop() {
+            head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
         }
 
-        friend bool operator==(const Date& _lhs, const Date& _rhs) {
-            return (_lhs.time_ == _rhs.time_ && _lhs.day_ == _rhs.day_ && _lhs.month_ == _rhs.month_ && _lhs.year_ == _rhs.year_);
+        std::uint64_t length() const {
+            std::size_t tail = tail_.load(std::memory_order_acquire);
+            std::size_t head = head_.load(std::memory_order_acquire);
+
+            return tail > head ? tail - head : 0;
         }
 
-        friend bool operator!=(const Date& _lhs, const Date& _rhs) {
-            return !(_lhs == _rhs);
+        bool empty() const {
+            return length() == 0;
         }
     };
 
     /**
      * @brief
-     * ExtendedMap - map container manager. Allows you to manage data in the form of key - value, save
-     * these values ​​to a file and read them. Supports string-key types and `any` values from the `std::any` library.
+     * PerThreadQueue gives every producer thread its own SpscRingBuffer, so producers never share cache lines. The
+     * consumer polls all registered buffers and merges the items in `Compare` order (e.g. by timestamp). Buffers of
+     * finished threads are removed when they become empty. Capacity is the capacity of a single thread buffer.
      */
-    class EMap {
-        std::map<std::string, std::any> values_;
+    template<class T, class Compare = std::less<T>>
+    class PerThreadQueue : public MessageQueue<T> {
+        struct ThreadBuffer {
+            explicit ThreadBuffer(const std::size_t _capacity) : ring(_capacity), closed(false) {}
+
+            SpscRingBuffer<T> ring;
+            std::atomic_bool closed; // Producer thread finished.
+        };
 
-    public:
         /**
-         * @brief Adds a new type or set the new value to existing key.
-         * @param _key Map key.
-         * @param _value Associated value with the key.
+         * @brief Producer thread registration, marks the buffer as closed when the thread finishes.
          */
-        void add(const std::string& _key, const std::any _value) {
-            if (containsKey(_key)) {
-                set(_key, _value);
-            } else {
-                values_.insert(std::make_pair(_key, _value));
-            }
-        }
-
-        /**
-         * @brief Changes existing key value.
-         * @param _key Map key.
-         * @param _value Associated value with the key.
-         */
-        void set(const std::string& _key, const std::any _value) {
-            values_.at(_key) = _value;
-        }
+        struct ThreadRegistration {
+            std::uint64_t queueId = 0;
+            std::shared_ptr<ThreadBuffer> buffer;
 
-        bool containsKey(const std::string& _key) {
-            if (std::map<std::string, std::any>::iterator it = values_.find(_key); it != values_.end()) {
-                return true;
+            ~ThreadRegistration() {
+                if (buffer) {
+                    buffer->closed.store(true, std::memory_order_release);
+                }
             }
+        };
 
-            return false;
-        }
-
-        /**
-         * @brief Gets value by key.
-         * @param _key Key sought.
-         * @return Associated value with the key, otherwise `empty` std::any.
-         */
-        std::any get(const std::string& _key) const {
-            std::any value;
+        inline static std::atomic<std::uint64_t> nextQueueId_{1};
 
-            try {
-                value = values_.at(_key);
-            } catch (const std::exception& _ex) {
-                std::cerr << "EMap: Cannot get map value for " << _key << " key" << std::endl;
-                value.reset();
-            }
+        const std::uint64_t queueId_; // Distinguishes queue instances in the thread registrations.
+        const std::size_t capacity_;
+        Compare compare_;
+        mutable std::mutex registryMutex_;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+        std::atomic<std::uint64_t> registryVersion_{0};
+        std::vector<std::shared_ptr<ThreadBuffer>> consumerBuffers_; // Consumer copy of the registered buffers.
+        std::uint64_t consumerVersion_ = 0;
 
-            return value;
-        }
+    public:
+        explicit PerThreadQueue(const std::size_t _capacity, Compare _compare = Compare())
+            : queueId_(nextQueueId_.fetch_add(1, std::memory_order_relaxed)), capacity_(_capacity), compare_(_compare) {
 
-        /**
-         * @brief Returns all map data.
-         */
-        std::map<std::string, std::any> data() const {
-            return values_;
         }
 
-        /**
-         * @brief Clears map container.
-         */
-        void clear() {
-            values_.clear();
+        void enqueue(T _queueItem) override {
+            ThreadBuffer& buffer = threadBuffer();
+            while (!buffer.ring.tryEnqueue(std::move(_queueItem))) {
+                std::this_thread::yield();
+            }
         }
 
-        /**
-         * @brief Checks the map file exists.
-         * @param _filename File where are stored map values.
-         * @return True if file exists, otherwise false.
-         */
-        bool isMapFileExists(const std::string& _filename) {
-            return std::filesystem::exists(_filename);
+        bool tryEnqueue(T&& _queueItem) override {
+            return threadBuffer().ring.tryEnqueue(std::move(_queueItem));
         }
 
-        /**
-         * @brief Writes map values to file.
-         * @param _filename The file where map data will be stored.
-         * @return True if successfully saved to file, otherwise false.
-         */
-        bool write(const std::string& _filename) {
-            bool status = true;
-            std::ofstream ofs;
-            ofs.exceptions(std::ofstream::badbit);
-
-            try {
-                ofs.open(_filename, std::ios::out);
+        bool tryDequeue(T& _queueItem) override {
+            refreshConsumerBuffers();
 
-                for (const auto& it: values_) {
-                    if (it.second.type() == typeid(std::string)) {
-                        ofs << it.first << " " << std::any_cast<std::string>(it.second) << std::endl;
-                    } else if (it.second.type() == typeid(int)) {
-                        ofs << it.first << " " << std::to_string(std::any_cast<int>(it.second)) << std::endl;
-                    } else if (it.second.type() == typeid(bool)) {
-                        ofs << it.first << " " << (std::any_cast<bool>(it.second) ? "true" : "false") << std::endl;
-                    } else {
-                        std::cerr << "EMap: Unexpected value type - " << it.second.type().name() << std::endl;
-                        status = false;
-                    }
+            ThreadBuffer* oldest = nullptr;
+            for (const auto& buffer: consumerBuffers_) {
+                if (T* item = buffer->ring.front(); item && (!oldest || compare_(*item, *oldest->ring.front()))) {
+                    oldest = buffer.get();
                 }
-            } catch (const std::ofstream::failure& _ex) {
-                std::cerr << "EMap: Unexpected error " << _ex.what() << std::endl;
-                status = false;
             }
 
-            if (ofs.is_open()) {
-                ofs.close();
+            if (!oldest) {
+                return false;
             }
 
-            return status;
+            _queueItem = std::move(*oldest->ring.front());
+            oldest->ring.pop();
+
+            return true;
         }
 
         /**
-         * @brief Appends single key value to the file.
-         * @param _filename The file where map data will be stored.
-         * @param _key Map key.
-         * @return True if successfully saved to file, otherwise false.
+         * @brief Removes up to `_maxItems` items merged from all thread buffers (k-way merge by `Compare`).
          */
-        bool append(const std::string& _filename, const std::string& _key) {
-            bool status = true;
-            std::ofstream ofs;
-            ofs.exceptions(std::ofstream::badbit);
+        std::size_t tryDequeueBulk(std::vector<T>& _queueItems, std::size_t _maxItems) override {
+            refreshConsumerBuffers();
 
-            try {
-                ofs.open(_filename, std::ios::app);
+            auto laterFront = [this](ThreadBuffer* _lhs, ThreadBuffer* _rhs) {
+                return compare_(*_rhs->ring.front(), *_lhs->ring.front());
+            };
 
-                if (std::any value = get(_key); value.has_value() && isMapFileExists(_filename)) {
-                    if (value.type() == typeid(std::string)) {
-                        ofs << _key << " " << std::any_cast<std::string>(value);
-                    } else if (value.type() == typeid(int)) {
-                        ofs << _key << " " << std::to_string(std::any_cast<int>(value));
-                    } else if (value.type() == typeid(bool)) {
-                        ofs << _key << " " << (std::any_cast<bool>(value) ? "true" : "false") << std::endl;
-                    } else {
-                        std::cerr << "EMap: Unexpected value type - " << value.type().name() << std::endl;
-                        status = false;
-                    }
-                } else {
-                    std::cerr << "File or key doesn't exist";
-                    status = false;
+            std::vector<ThreadBuffer*> heap;
+            for (const auto& buffer: consumerBuffers_) {
+                if (buffer->ring.front()) {
+                    heap.push_back(buffer.get());
                 }
-            } catch (const std::ofstream::failure& _ex) {
-                std::cerr << "EMap: Unexpected error " << _ex.what() << std::endl;
-                status = false;
             }
+            std::make_heap(heap.begin(), heap.end(), laterFront);
 
-            if (ofs.is_open()) {
-                ofs.close();
+            std::size_t count = 0;
+            while (count < _maxItems && !heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), laterFront);
+                ThreadBuffer* buffer = heap.back();
+
+                _queueItems.push_back(std::move(*buffer->ring.front()));
+                buffer->ring.pop();
+                count++;
+
+                if (buffer->ring.front()) {
+                    std::push_heap(heap.begin(), heap.end(), laterFront);
+                } else {
+                    heap.pop_back();
+                }
             }
 
-            return status;
+            return count;
         }
 
-        /**
-         * @brief Reads all map values from the file and loads to local container.
-         * @param _filename The file where map data will be stored.
-         * @param True if successfully read from file, otherwise false.
-         */
-        bool read(const std::string& _filename) {
-            bool status = true;
-            std::ifstream ifs;
-            ifs.exceptions(std::ifstream::badbit);
+        void clear() override {
+            T queueItem;
+            while (tryDequeue(queueItem)) {}
+        }
 
-            try {
-                ifs.open(_filename, std::ios::out);
+        std::uint64_t length() const override {
+            std::lock_guard<std::mutex> lock(registryMutex_);
 
-                std::string key, value;
-                while (ifs >> key >> value) {
-                    if (isNumber(value)) {
-                        add(key, std::stoi(value));
-                    } else if (isBool(value)) {
-                        add(key, toBool(value));
-                    } else {
-                        add(key, value);
-                    }
-                }
-            } catch (const std::ofstream::failure& _ex) {
-                std::cerr << "EMap: Unexpected error " << _ex.what() << std::endl;
-                status = false;
+            std::uint64_t length = 0;
+            for (const auto& buffer: buffers_) {
+                length += buffer->ring.length();
             }
 
-            return status;
+            return length;
         }
 
-    protected:
-        /**
-         * @brief Checks given text is a number. Used for parsing map file.
-         * @param _str Potentially the number as text.
-         * @return True when the text is a number, otherwise false.
-         */
-        bool isNumber(const std::string& _str) {
-            return !_str.empty() && std::find_if(_str.begin(), _str.end(), [](unsigned char c) { return !std::isdigit(c); }) == _str.end();
+        bool empty() const override {
+            return length() == 0;
+        }
+
+        bool isMultiConsumer() const override {
+            return false;
         }
 
+    private:
         /**
-         * @brief Checks given text is a bool. We accept ONLY `true` and `false` - not numerical representation `0` or `1`.
-         * @param _str Potentially bool as text.
-         * @return True when text is compare to the `true` or `false`, otherwise false.
+         * @brief Returns buffer of the calling thread, registers a new one on the first call.
          */
-        bool isBool(std::string _str) {
-            std::transform(_str.begin(), _str.end(), _str.begin(), ::tolower);
-            return _str.compare("true") == 0 || _str.compare("false") == 0;
+        ThreadBuffer& threadBuffer() {
+            thread_local ThreadRegistration registration;
+
+            if (registration.queueId != queueId_) {
+                if (registration.buffer) {
+                    registration.buffer->closed.store(true, std::memory_order_release);
+                }
+
+                registration.buffer = std::make_shared<ThreadBuffer>(capacity_);
+                registration.queueId = queueId_;
+
+                std::lock_guard<std::mutex> lock(registryMutex_);
+                buffers_.push_back(registration.buffer);
+                registryVersion_.fetch_add(1, std::memory_order_release);
+            }
+
+            return *registration.buffer;
         }
 
         /**
-         * @brief Converts given text to bool.
-         * @param _str Potentially bool as text.
-         * @return Converted text to bool.
-         * @throw std::invalid_argument When the conversion failed.
+         * @brief Updates consumer copy of the registered buffers and removes drained buffers of finished threads.
          */
-        bool toBool(std::string _str) {
-            std::transform(_str.begin(), _str.end(), _str.begin(), ::tolower);
-            std::istringstream is(_str);
-
-            bool b;
-            is >> std::boolalpha >> b;
+        void refreshConsumerBuffers() {
+            bool anyClosed = false;
+            for (const auto& buffer: consumerBuffers_) {
+                anyClosed |= buffer->closed.load(std::memory_order_acquire) && buffer->ring.empty();
+            }
 
-            // Some error may occured.
-            if (!is.good()) {
-                throw std::invalid_argument("EMap: Expected bool value");
+            if (!anyClosed && consumerVersion_ == registryVersion_.load(std::memory_order_acquire)) {
+                return;
             }
 
-            return b;
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(), [](const std::shared_ptr<ThreadBuffer>& _buffer) {
+                return _buffer->closed.load(std::memory_order_acquire) && _buffer->ring.empty();
+            }), buffers_.end());
+
+            consumerBuffers_ = buffers_;
+            consumerVersion_ = registryVersion_.load(std::memory_order_acquire);
         }
     };
 
     /**
-     * @brief The Timer class allows you to measuring time or execute callback function in intervals.
+     * @brief
+     * WaitStrategy parks the queue consumer when there is nothing to process. The consumer spins first, then yields
+     * and finally blocks on the condition variable until a producer signals a new item. The spin budget adapts: it grows
+     * when items arrive while spinning and shrinks when the consumer has to park.
      */
-    template<typename Clock = std::chrono::high_resolution_clock>
-    class Timer {
-        typedef unsigned long long time_t;
+    class WaitStrategy {
+        static constexpr unsigned MAX_SPINS = 4096;
+        static constexpr unsigned YIELDS = 16;
 
-        typename Clock::time_point startPoint_, stopPoint_; // Start / stop snapshots.
-        std::atomic_bool execute_; // Is a timer currently working?
-        std::thread timerThread_; // The timer processing thread (callback execution).
+        std::mutex mutex_;
+        std::condition_variable conditionVariable_;
+        std::atomic_bool parked_{false};
+        unsigned spins_ = 256; // Current spin budget (consumer thread only).
 
     public:
         /**
-         * Second, minute, hour, day in milliseconds.
-         */
-        inline static struct TimeToMilliseconds {
-            constexpr static time_t MILLISECOND = 1;
-            constexpr static time_t SECOND = 1000;
-            constexpr static time_t MINUTE = 60000;
-            constexpr static time_t HOUR = 3600000;
-            constexpr static time_t DAY = 86400000;
-            // May no correct precision.
-            constexpr static time_t WEEK = 604800000;
-            constexpr static time_t MONTH = 2629746000;
-            constexpr static time_t YEAR = 31556952000;
-        } Milliseconds;
-
-        /**
-         * Minute, hour, day in seconds.
+         * @brief Wakes up the parked consumer. Called by producers after publishing an item.
          */
-        inline static struct TimeToSeconds {
-            constexpr static time_t SECOND = 1;
-            constexpr static time_t MINUTE = 60;
-            constexpr static time_t HOUR = 3600;
-            constexpr static time_t DAY = 86400;
-            // May no correct precision.
-            constexpr static time_t WEEK = 604800;
-            constexpr static time_t MONTH = 2629746;
-            constexpr static time_t YEAR = 31556952;
-        } Seconds;
-
-        Timer() {
-            execute_.store(false, std::memory_order_release);
-        }
-
-        ~Timer() {
-            // If someone forget stop timer manually.
-            if (execute_.load(std::memory_order_acquire)) {
-                stop();
+        void notify() {
+            // Pairs with the fence in `wait` - either we see the parked consumer or the consumer sees our item.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (parked_.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                conditionVariable_.notify_one();
             }
         }
 
         /**
-         * @brief State of timer.
-         * @return If timer is currently running returns true.
+         * @brief Wakes up the consumer unconditionally (e.g. on stop).
          */
-        bool isRunning() const {
-            return execute_;
+        void notifyAll() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            conditionVariable_.notify_all();
         }
 
         /**
-         * @brief Timer start snapshot.
-         * @return Start point with `Clock` precision.
+         * @brief Waits until predicate is satisfied or timeout elapsed.
+         * @param _ready Condition to wait for, e.g. the queue is not empty.
+         * @param _timeout Max time to block in the parked state.
+         * @return Predicate result.
          */
-        std::chrono::time_point<Clock> startTime() const {
-            return startPoint_;
-        }
+        template<typename Predicate, typename Rep, typename Period>
+        bool wait(Predicate _ready, const std::chrono::duration<Rep, Period>& _timeout) {
+            for (unsigned spin = 0; spin < spins_; spin++) {
+                if (_ready()) {
+                    spins_ = std::min(spins_ * 2, MAX_SPINS);
+                    return true;
+                }
+            }
 
-        /**
-         * @brief Starts the timer.
-         */
-        void start() {
-            if (execute_.load(std::memory_order_acquire)) {
-                return;
+            for (unsigned yield = 0; yield < YIELDS; yield++) {
+                if (_ready()) {
+                    return true;
+                }
+
+                std::this_thread::yield();
             }
 
-            startPoint_ = Clock::now();
-        }
+            spins_ = std::max(spins_ / 2, 1u);
 
-        /**
-         * @brief Run callback method with specific interval.
-         * @param _interval The callback interval.
+            parked_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            bool ready;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready = conditionVariable_.wait_for(lock, _timeout, _ready);
+            }
+
+            parked_.store(false, std::memory_order_relaxed);
+            return ready;
+        }
+    };
+
+    /**
+     * @brief The Date class is a simple wrapper around `tm struct` from the ctime library.
+     */
+    class Date {
+        int day_; // Day of month [1; 31]
+        int month_; // Month of year [0, 11]
+        int year_; // Year since 1900
+
+    public:
+        /**
+         * @brief The Time struct represent time in format h:m:s.
+         */
+        struct Time {
+            Time(const int _hour = 0, const int _minute = 0, const int _second = 0) {
+                this->hour = _hour;
+                this->minute = _minute;
+                this->second = _second;
+            }
+
+            friend bool operator==(const Time& _lhs, const Time& _rhs) {
+                return (_lhs.hour == _rhs.hour && _lhs.minute == _rhs.minute && _lhs.second == _rhs.second);
+            }
+
+            friend bool operator!=(const Time& _lhs, const Time& _rhs) {
+                return !(_lhs == _rhs);
+            }
+
+            friend bool operator<(const Time& _lhs, const Time& _rhs) {
+                return (_lhs.hour < _rhs.hour && _lhs.minute < _rhs.minute && _lhs.second < _rhs.second);
+            }
+
+            friend bool operator>(const Time& _lhs, const Time& _rhs) {
+                return (_lhs < _rhs);
+            }
+
+            friend bool operator<=(const Time& _lhs, const Time& _rhs) {
+                return !(_lhs > _rhs);
+            }
+
+            friend bool operator>=(const Time& _lhs, const Time& _rhs) {
+                return !(_lhs < _rhs);
+            }
+
+            std::string toString() const {
+                return addTrailingZero(this->hour) + ":" + addTrailingZero(this->minute) + ":" + addTrailingZero(this->second);
+            }
+
+            static std::string toString(const Time _time) {
+                return addTrailingZero(_time.hour) + ":" + addTrailingZero(_time.minute) + ":" + addTrailingZero(_time.second);
+            }
+
+            int hour; // Hours of day [0; 23]
+            int minute; // Minutes of hour [0; 59]
+            int second; // Seconds of minutes [0; 60]
+
+        private:
+            static std::string addTrailingZero(int _value) {
+                return _value >= 0 && _value <= 9 ? "0" + std::to_string(_value) : std::to_string(_value);
+            }
+        } time_; // Hour, minute and second
+
+        Date() : day_(1), month_(0), year_(1900), time_(0, 0, 0) {
+
+        }
+
+        int hour() const {
+            return time_.hour;
+        }
+
+        int minute() const {
+            return time_.minute;
+        }
+
+        int second() const {
+            return time_.second;
+        }
+
+        Time time() const {
+            return time_;
+        }
+
+        int day() const {
+            return day_;
+        }
+
+        int month() const {
+            return month_;
+        }
+
+        int year() const {
+            return year_;
+        }
+
+        Date& setSeconds(int _seconds) {
+            assert(_seconds >= 0 && _seconds <= 59);
+
+            time_.second = _seconds;
+            return *this;
+        }
+
+        Date& setMinutes(int _minutes) {
+            assert(_minutes >= 0 && _minutes <= 59);
+
+            time_.minute = _minutes;
+            return *this;
+        }
+
+        Date& setHour(int _hour) {
+            assert(_hour >= 0 && _hour <= 23);
+
+            time_.hour = _hour;
+            return *this;
+        }
+
+        Date& setDay(int _day) {
+            assert(_day >= 1 && _day <= 31);
+
+            day_ = _day;
+            return *this;
+        }
+
+        Date& setMonth(int _month) {
+            assert(_month >= 1 && _month <= 12);
+
+            month_ = _month;
+            return *this;
+        }
+
+        Date& setYear(int _year) {
+            assert(_year > 0);
+
+            year_ = _year;
+            return *this;
+        }
+
+        /**
+         * @brief Returns current date.
+         * @return Hour, minute, second, day, month and year.
+         */
+        static Date now() {
+            std::time_t now = std::time(0);
+            std::tm localTime = toLocalTime(now);
+
+            Date date;
+            date.time_.second = localTime.tm_sec;
+            date.time_.minute = localTime.tm_min;
+            date.time_.hour = localTime.tm_hour;
+            date.day_ = localTime.tm_mday;
+            date.month_ = localTime.tm_mon + 1;
+            date.year_ = localTime.tm_year + 1900;
+
+            return date;
+        }
+
+        /**
+         * @brief Thread safe conversion to the local time (`std::localtime` shares a static buffer between threads).
+         * @param _time Time since epoch.
+         * @return Local calendar time.
+         */
+        static std::tm toLocalTime(const std::time_t _time) {
+            std::tm localTime{};
+#ifdef _WIN32
+            localtime_s(&localTime, &_time);
+#else
+            localtime_r(&_time, &localTime);
+#endif
+            return localTime;
+        }
+
+        /**
+         * @brief Returns current time.
+         * @return Hour, minute and second.
+         */
+        static Time currentTime() {
+            Date currentDate = now();
+            return currentDate.time();
+        }
+
+        friend bool operator==(const Date& _lhs, const Date& _rhs) {
+            return (_lhs.time_ == _rhs.time_ && _lhs.day_ == _rhs.day_ && _lhs.month_ == _rhs.month_ && _lhs.year_ == _rhs.year_);
+        }
+
+        friend bool operator!=(const Date& _lhs, const Date& _rhs) {
+            return !(_lhs == _rhs);
+        }
+    };
+
+    /**
+     * @brief
+     * TimestampCache renders `YYYY-MM-DD HH:MM:SS[.mmm|.uuuuuu]` timestamps. The date and time part is recomputed only
+     * when the second changes, sub-second digits are patched in place. It's not thread safe - use one instance per thread.
+     */
+    class TimestampCache {
+    public:
+        enum class Precision {
+            Seconds, Milliseconds, Microseconds
+        };
+
+    private:
+        static constexpr std::size_t SECONDS_LENGTH = 19; // YYYY-MM-DD HH:MM:SS
+
+        Precision precision_;
+        std::int64_t cachedSecond_; // Seconds since epoch of the cached date and time part.
+        char buffer_[32];
+
+    public:
+        explicit TimestampCache(const Precision _precision = Precision::Seconds)
+            : precision_(_precision), cachedSecond_(std::numeric_limits<std::int64_t>::min()), buffer_() {
+
+        }
+
+        Precision precision() const {
+            return precision_;
+        }
+
+        void setPrecision(const Precision _precision) {
+            precision_ = _precision;
+        }
+
+        /**
+         * @brief Formats given time.
+         * @param _timePoint Time to format.
+         * @return Formatted timestamp, valid until the next call.
+         */
+        std::string_view format(const std::chrono::system_clock::time_point _timePoint) {
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(_timePoint.time_since_epoch()).count();
+            std::int64_t second = micros / 1000000;
+            std::int64_t subSecond = micros % 1000000;
+            if (subSecond < 0) {
+                second--;
+                subSecond += 1000000;
+            }
+
+            if (second != cachedSecond_) {
+                std::tm localTime = Date::toLocalTime(static_cast<std::time_t>(second));
+                std::strftime(buffer_, sizeof(buffer_), "%Y-%m-%d %H:%M:%S", &localTime);
+                cachedSecond_ = second;
+            }
+
+            switch (precision_) {
+                case Precision::Milliseconds:
+                    buffer_[SECONDS_LENGTH] = '.';
+                    writeDigits(buffer_ + SECONDS_LENGTH + 1, subSecond / 1000, 3);
+                    return std::string_view(buffer_, SECONDS_LENGTH + 4);
+                case Precision::Microseconds:
+                    buffer_[SECONDS_LENGTH] = '.';
+                    writeDigits(buffer_ + SECONDS_LENGTH + 1, subSecond, 6);
+                    return std::string_view(buffer_, SECONDS_LENGTH + 7);
+                case Precision::Seconds:
+                default:
+                    return std::string_view(buffer_, SECONDS_LENGTH);
+            }
+        }
+
+    private:
+        static void writeDigits(char* _output, std::int64_t _value, int _digits) {
+            for (int i = _digits - 1; i >= 0; i--) {
+                _output[i] = static_cast<char>('0' + _value % 10);
+                _value /= 10;
+            }
+        }
+    };
+
+    /**
+     * @brief
+     * ExtendedMap - map container manager. Allows you to manage data in the form of key - value, save
+     * these values ​​to a file and read them. Supports string-key types and `any` values from the `std::any` library.
+     */
+    class EMap {
+        std::map<std::string, std::any> values_;
+
+    public:
+        /**
+         * @brief Adds a new type or set the new value to existing key.
+         * @param _key Map key.
+         * @param _value Associated value with the key.
+         */
+        void add(const std::string& _key, const std::any _value) {
+            if (containsKey(_key)) {
+                set(_key, _value);
+            } else {
+                values_.insert(std::make_pair(_key, _value));
+            }
+        }
+
+        /**
+         * @brief Changes existing key value.
+         * @param _key Map key.
+         * @param _value Associated value with the key.
+         */
+        void set(const std::string& _key, const std::any _value) {
+            values_.at(_key) = _value;
+        }
+
+        bool containsKey(const std::string& _key) {
+            if (std::map<std::string, std::any>::iterator it = values_.find(_key); it != values_.end()) {
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Gets value by key.
+         * @param _key Key sought.
+         * @return Associated value with the key, otherwise `empty` std::any.
+         */
+        std::any get(const std::string& _key) const {
+            std::any value;
+
+            try {
+                value = values_.at(_key);
+            } catch (const std::exception& _ex) {
+                std::cerr << "EMap: Cannot get map value for " << _key << " key" << std::endl;
+                value.reset();
+            }
+
+            return value;
+        }
+
+        /**
+         * @brief Returns all map data.
+         */
+        std::map<std::string, std::any> data() const {
+            return values_;
+        }
+
+        /**
+         * @brief Clears map container.
+         */
+        void clear() {
+            values_.clear();
+        }
+
+        /**
+         * @brief Checks the map file exists.
+         * @param _filename File where are stored map values.
+         * @return True if file exists, otherwise false.
+         */
+        bool isMapFileExists(const std::string& _filename) {
+            return std::filesystem::exists(_filename);
+        }
+
+        /**
+         * @brief Writes map values to file.
+         * @param _filename The file where map data will be stored.
+         * @return True if successfully saved to file, otherwise false.
+         */
+        bool write(const std::string& _filename) {
+            bool status = true;
+            std::ofstream ofs;
+            ofs.exceptions(std::ofstream::badbit);
+
+            try {
+                ofs.open(_filename, std::ios::out);
+
+                for (const auto& it: values_) {
+                    if (it.second.type() == typeid(std::string)) {
+                        ofs << it.first << " " << std::any_cast<std::string>(it.second) << std::endl;
+                    } else if (it.second.type() == typeid(int)) {
+                        ofs << it.first << " " << std::to_string(std::any_cast<int>(it.second)) << std::endl;
+                    } else if (it.second.type() == typeid(bool)) {
+                        ofs << it.first << " " << (std::any_cast<bool>(it.second) ? "true" : "false") << std::endl;
+                    } else {
+                        std::cerr << "EMap: Unexpected value type - " << it.second.type().name() << std::endl;
+                        status = false;
+                    }
+                }
+            } catch (const std::ofstream::failure& _ex) {
+                std::cerr << "EMap: Unexpected error " << _ex.what() << std::endl;
+                status = false;
+            }
+
+            if (ofs.is_open()) {
+                ofs.close();
+            }
+
+            return status;
+        }
+
+        /**
+         * @brief Appends single key value to the file.
+         * @param _filename The file where map data will be stored.
+         * @param _key Map key.
+         * @return True if successfully saved to file, otherwise false.
+         */
+        bool append(const std::string& _filename, const std::string& _key) {
+            bool status = true;
+            std::ofstream ofs;
+            ofs.exceptions(std::ofstream::badbit);
+
+            try {
+                ofs.open(_filename, std::ios::app);
+
+                if (std::any value = get(_key); value.has_value() && isMapFileExists(_filename)) {
+                    if (value.type() == typeid(std::string)) {
+                        ofs << _key << " " << std::any_cast<std::string>(value);
+                    } else if (value.type() == typeid(int)) {
+                        ofs << _key << " " << std::to_string(std::any_cast<int>(value));
+                    } else if (value.type() == typeid(bool)) {
+                        ofs << _key << " " << (std::any_cast<bool>(value) ? "true" : "false") << std::endl;
+                    } else {
+                        std::cerr << "EMap: Unexpected value type - " << value.type().name() << std::endl;
+                        status = false;
+                    }
+                } else {
+                    std::cerr << "File or key doesn't exist";
+                    status = false;
+                }
+            } catch (const std::ofstream::failure& _ex) {
+                std::cerr << "EMap: Unexpected error " << _ex.what() << std::endl;
+                status = false;
+            }
+
+            if (ofs.is_open()) {
+                ofs.close();
+            }
+
+            return status;
+        }
+
+        /**
+         * @brief Reads all map values from the file and loads to local container.
+         * @param _filename The file where map data will be stored.
+         * @param True if successfully read from file, otherwise false.
+         */
+        bool read(const std::string& _filename) {
+            bool status = true;
+            std::ifstream ifs;
+            ifs.exceptions(std::ifstream::badbit);
+
+            try {
+                ifs.open(_filename, std::ios::out);
+
+                std::string key, value;
+                while (ifs >> key >> value) {
+                    if (isNumber(value)) {
+                        add(key, std::stoi(value));
+                    } else if (isBool(value)) {
+                        add(key, toBool(value));
+                    } else {
+                        add(key, value);
+                    }
+                }
+            } catch (const std::ofstream::failure& _ex) {
+                std::cerr << "EMap: Unexpected error " << _ex.what() << std::endl;
+                status = false;
+            }
+
+            return status;
+        }
+
+    protected:
+        /**
+         * @brief Checks given text is a number. Used for parsing map file.
+         * @param _str Potentially the number as text.
+         * @return True when the text is a number, otherwise false.
+         */
+        bool isNumber(const std::string& _str) {
+            return !_str.empty() && std::find_if(_str.begin(), _str.end(), [](unsigned char c) { return !std::isdigit(c); }) == _str.end();
+        }
+
+        /**
+         * @brief Checks given text is a bool. We accept ONLY `true` and `false` - not numerical representation `0` or `1`.
+         * @param _str Potentially bool as text.
+         * @return True when text is compare to the `true` or `false`, otherwise false.
+         */
+        bool isBool(std::string _str) {
+            std::transform(_str.begin(), _str.end(), _str.begin(), ::tolower);
+            return _str.compare("true") == 0 || _str.compare("false") == 0;
+        }
+
+        /**
+         * @brief Converts given text to bool.
+         * @param _str Potentially bool as text.
+         * @return Converted text to bool.
+         * @throw std::invalid_argument When the conversion failed.
+         */
+        bool toBool(std::string _str) {
+            std::transform(_str.begin(), _str.end(), _str.begin(), ::tolower);
+            std::istringstream is(_str);
+
+            bool b;
+            is >> std::boolalpha >> b;
+
+            // Some error may occured.
+            if (!is.good()) {
+                throw std::invalid_argument("EMap: Expected bool value");
+            }
+
+            return b;
+        }
+    };
+
+    /**
+     * @brief The Timer class allows you to measuring time or execute callback function in intervals.
+     */
+    template<typename Clock = std::chrono::high_resolution_clock>
+    class Timer {
+        typedef unsigned long long time_t;
+
+        typename Clock::time_point startPoint_, stopPoint_; // Start / stop snapshots.
+        std::atomic_bool execute_; // Is a timer currently working?
+        std::thread timerThread_; // The timer processing thread (callback execution).
+
+    public:
+        /**
+         * Second, minute, hour, day in milliseconds.
+         */
+        inline static struct TimeToMilliseconds {
+            constexpr static time_t MILLISECOND = 1;
+            constexpr static time_t SECOND = 1000;
+            constexpr static time_t MINUTE = 60000;
+            constexpr static time_t HOUR = 3600000;
+            constexpr static time_t DAY = 86400000;
+            // May no correct precision.
+            constexpr static time_t WEEK = 604800000;
+            constexpr static time_t MONTH = 2629746000;
+            constexpr static time_t YEAR = 31556952000;
+        } Milliseconds;
+
+        /**
+         * Minute, hour, day in seconds.
+         */
+        inline static struct TimeToSeconds {
+            constexpr static time_t SECOND = 1;
+            constexpr static time_t MINUTE = 60;
+            constexpr static time_t HOUR = 3600;
+            constexpr static time_t DAY = 86400;
+            // May no correct precision.
+            constexpr static time_t WEEK = 604800;
+            constexpr static time_t MONTH = 2629746;
+            constexpr static time_t YEAR = 31556952;
+        } Seconds;
+
+        Timer() {
+            execute_.store(false, std::memory_order_release);
+        }
+
+        ~Timer() {
+            // If someone forget stop timer manually.
+            if (execute_.load(std::memory_order_acquire)) {
+                stop();
+            }
+        }
+
+        /**
+         * @brief State of timer.
+         * @return If timer is currently running returns true.
+         */
+        bool isRunning() const {
+            return execute_;
+        }
+
+        /**
+         * @brief Timer start snapshot.
+         * @return Start point with `Clock` precision.
+         */
+        std::chrono::time_point<Clock> startTime() const {
+            return startPoint_;
+        }
+
+        /**
+         * @brief Starts the timer.
+         */
+        void start() {
+            if (execute_.load(std::memory_order_acquire)) {
+                return;
+            }
+
+            startPoint_ = Clock::now();
+        }
+
+        /**
+         * @brief Run callback method with specific interval.
+         * @param _interval The callback interval.
+         * @param _callback The callback method.
+         */
+        template<typename Rep, typename Period>
+        void startInterval(const std::chrono::duration<Rep, Period>& _interval, std::function<void()> _callback) {
+            if (execute_.load(std::memory_order_acquire)) {
+                stop();
+            }
+
+            execute_.store(true, std::memory_order_release);
+            timerThread_ = std::thread([=]() {
+                while (execute_.load(std::memory_order_acquire)) {
+                    if (_callback) {
+                        _callback();
+                    }
+
+                    std::this_thread::sleep_for(_interval);
+                }
+            });
+        }
+
+        /**
+         * @brief Run callback method specific timeout.
+         * @param _interval The callback interval.
          * @param _callback The callback method.
          */
-        template<typename Rep, typename Period>
-        void startInterval(const std::chrono::duration<Rep, Period>& _interval, std::function<void()> _callback) {
-            if (execute_.load(std::memory_order_acquire)) {
-                stop();
+        template<typename Rep, typename Period>
+        void setTimeout(const std::chrono::duration<Rep, Period>& _interval, std::function<void()> _callback) {
+            timerThread_ = std::thread([=]() {
+                std::this_thread::sleep_for(_interval);
+
+                if (_callback) {
+                    _callback();
+                }
+            });
+        }
+
+        /**
+         * @brief Stops timer.
+         */
+        void stop() {
+            stopPoint_ = Clock::now();
+
+            // Wait for thread execution.
+            execute_.store(false, std::memory_order_release);
+            if (timerThread_.joinable()) {
+                timerThread_.join();
+            }
+        }
+
+        /**
+         * @brief Returns current elapsed time (between start and stop snapshot).
+         * @return The timer elapsed time.
+         */
+        template<typename Rep = typename Clock::duration::rep, typename Units = typename Clock::duration>
+        Rep elapsedTime() {
+            std::atomic_thread_fence(std::memory_order_relaxed);
+            auto countedTime = std::chrono::duration_cast<Units>(startPoint_ - stopPoint_).count();
+            std::atomic_thread_fence(std::memory_order_relaxed);
+
+            return static_cast<Rep>(countedTime);
+        }
+    };
+
+    // Predefined timers types.
+    using PreciseTimer = Timer<>;
+    using SystemTimer = Timer<std::chrono::system_clock>;
+    using SteadyTimer = Timer<std::chrono::steady_clock>;
+
+    /**
+     * @brief
+     * LatencyHistogram counts durations (nanoseconds) in HDR-style log-linear buckets: every power of two range is split
+     * into SUB_BUCKETS equal buckets, so the reported values (bucket upper bounds) are within 1/SUB_BUCKETS of the recorded
+     * ones. Durations below SUB_BUCKETS ns have exact buckets.
+     *
+     * Recording is done by a single thread without read-modify-write operations, the histogram can be read by any thread
+     * at any time (the snapshot is not atomic as a whole, concurrent records may be partially visible).
+     */
+    class LatencyHistogram {
+        static constexpr std::size_t SUB_BUCKET_BITS = 4;
+
+    public:
+        static constexpr std::size_t SUB_BUCKETS = std::size_t(1) << SUB_BUCKET_BITS;
+        static constexpr std::size_t BUCKETS = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+        /**
+         * @brief Copy of the bucket counts (used to compute the summary of the interval between two snapshots).
+         */
+        struct Snapshot {
+            std::vector<std::uint64_t> counts;
+            std::uint64_t sum = 0;
+        };
+
+        struct Summary {
+            std::uint64_t count = 0;
+            std::chrono::nanoseconds min{0};
+            std::chrono::nanoseconds mean{0};
+            std::chrono::nanoseconds p50{0};
+            std::chrono::nanoseconds p90{0};
+            std::chrono::nanoseconds p99{0};
+            std::chrono::nanoseconds p999{0};
+            std::chrono::nanoseconds max{0};
+        };
+
+    private:
+        std::array<std::atomic<std::uint64_t>, BUCKETS> counts_{};
+        std::atomic<std::uint64_t> sum_{0};
+
+    public:
+        /**
+         * @brief Records the duration (single writer).
+         */
+        void record(const std::chrono::nanoseconds _duration) {
+            std::uint64_t value = _duration.count() > 0 ? static_cast<std::uint64_t>(_duration.count()) : 0;
+            auto& count = counts_[bucket(value)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        Snapshot snapshot() const {
+            Snapshot snapshot;
+            snapshot.counts.resize(BUCKETS);
+            for (std::size_t i = 0; i < BUCKETS; i++) {
+                snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+            }
+            snapshot.sum = sum_.load(std::memory_order_relaxed);
+
+            return snapshot;
+        }
+
+        /**
+         * @brief Summary of all recorded durations.
+         */
+        Summary summary() const {
+            return summarize(snapshot(), Snapshot());
+        }
+
+        /**
+         * @brief Summary of the durations recorded between two snapshots.
+         * @param _current Current snapshot.
+         * @param _since Previous snapshot (empty - since the beginning).
+         */
+        static Summary summarize(const Snapshot& _current, const Snapshot& _since) {
+            Summary summary;
+            std::vector<std::uint64_t> counts(BUCKETS, 0);
+            for (std::size_t i = 0; i < BUCKETS && i < _current.counts.size(); i++) {
+                counts[i] = _current.counts[i] - (i < _since.counts.size() ? _since.counts[i] : 0);
+                summary.count += counts[i];
+            }
+
+            if (summary.count == 0) {
+                return summary;
+            }
+
+            summary.mean = std::chrono::nanoseconds((_current.sum - _since.sum) / summary.count);
+            summary.p50 = percentile(counts, summary.count, 50.0);
+            summary.p90 = percentile(counts, summary.count, 90.0);
+            summary.p99 = percentile(counts, summary.count, 99.0);
+            summary.p999 = percentile(counts, summary.count, 99.9);
+
+            std::size_t first = 0, last = BUCKETS - 1;
+            while (counts[first] == 0) {
+                first++;
+            }
+            while (counts[last] == 0) {
+                last--;
+            }
+            summary.min = std::chrono::nanoseconds(lowerBound(first));
+            summary.max = std::chrono::nanoseconds(upperBound(last));
+
+            return summary;
+        }
+
+    private:
+        static std::size_t bucket(const std::uint64_t _value) {
+            if (_value < SUB_BUCKETS) {
+                return static_cast<std::size_t>(_value);
+            }
+
+            std::size_t exponent = 63 - static_cast<std::size_t>(__builtin_clzll(_value));
+            std::size_t subBucket = static_cast<std::size_t>(_value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+            return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + subBucket;
+        }
+
+        static std::uint64_t lowerBound(const std::size_t _bucket) {
+            if (_bucket < SUB_BUCKETS) {
+                return _bucket;
+            }
+
+            std::size_t shift = (_bucket - SUB_BUCKETS) / SUB_BUCKETS;
+            return static_cast<std::uint64_t>(SUB_BUCKETS + (_bucket - SUB_BUCKETS) % SUB_BUCKETS) << shift;
+        }
+
+        static std::uint64_t upperBound(const std::size_t _bucket) {
+            if (_bucket < SUB_BUCKETS) {
+                return _bucket;
+            }
+
+            std::size_t shift = (_bucket - SUB_BUCKETS) / SUB_BUCKETS;
+            return lowerBound(_bucket) + (std::uint64_t(1) << shift) - 1;
+        }
+
+        static std::chrono::nanoseconds percentile(const std::vector<std::uint64_t>& _counts, const std::uint64_t _total, const double _percent) {
+            auto rank = static_cast<std::uint64_t>(std::ceil(_percent / 100.0 * static_cast<double>(_total)));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < _counts.size(); i++) {
+                seen += _counts[i];
+                if (seen >= std::max<std::uint64_t>(rank, 1)) {
+                    return std::chrono::nanoseconds(upperBound(i));
+                }
+            }
+
+            return std::chrono::nanoseconds(0);
+        }
+    };
+
+    /**
+     * @brief
+     * ShardedCounters is a set of monotonic counters split into cache line aligned shards. Every thread adds to its own
+     * shard (threads are assigned to shards round robin), so concurrent updates rarely share a cache line. Reading sums
+     * all shards and never blocks the writers.
+     */
+    template<std::size_t Counters>
+    class ShardedCounters {
+        static constexpr std::size_t CACHE_LINE_SIZE = 64;
+        static constexpr std::size_t SHARDS = 16;
+
+        struct alignas(CACHE_LINE_SIZE) Shard {
+            std::array<std::atomic<std::uint64_t>, Counters> values{};
+        };
+
+        std::array<Shard, SHARDS> shards_{};
+
+    public:
+        void add(const std::size_t _counter, const std::uint64_t _value = 1) {
+            shards_[shard()].values[_counter].fetch_add(_value, std::memory_order_relaxed);
+        }
+
+        std::uint64_t load(const std::size_t _counter) const {
+            std::uint64_t value = 0;
+            for (const auto& shard: shards_) {
+                value += shard.values[_counter].load(std::memory_order_relaxed);
+            }
+
+            return value;
+        }
+
+    private:
+        static std::size_t shard() {
+            static std::atomic<std::size_t> nextShard{0};
+            thread_local std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+            return shard;
+        }
+    };
+
+    /**
+     * @brief File size representation.
+     */
+    typedef struct FileSize {
+        enum class SizeUnit {
+            B = 1, KB = 1000, KiB = 1024, MB = 1000000, MiB = 1048576, GB = 1000000000, GiB = 1073741824
+        };
+
+        FileSize() : size(1), unit(SizeUnit::B) {}
+
+        FileSize(const std::uintmax_t _size, const SizeUnit _unit) {
+            this->size = _size;
+            this->unit = _unit;
+        }
+
+        friend bool operator==(const FileSize& _lhs, const FileSize& _rhs) {
+            return (_lhs.size == _rhs.size && _lhs.unit == _rhs.unit);
+        }
+
+        friend bool operator!=(const FileSize& _lhs, const FileSize& _rhs) {
+            return !(_lhs == _rhs);
+        }
+
+        friend bool operator<(const FileSize& _lhs, const FileSize& _rhs) {
+            return (_lhs.bsize() < _rhs.bsize());
+        }
+
+        friend bool operator>(const FileSize& _lhs, const FileSize& _rhs) {
+            return (_lhs < _rhs);
+        }
+
+        friend bool operator<=(const FileSize& _lhs, const FileSize& _rhs) {
+            return !(_lhs > _rhs);
+        }
+
+        friend bool operator>=(const FileSize& _lhs, const FileSize& _rhs) {
+            return !(_lhs < _rhs);
+        }
+
+        /**
+         * @brief Returns size in bytes.
+         */
+        std::uintmax_t bsize() const {
+            return this->size * static_cast<std::uintmax_t>(this->unit);
+        }
+
+        /**
+         * @brief See static `toString` implementation.
+         */
+        std::string toString() const {
+            return FileSize::toString(this->size, this->unit);
+        }
+
+        /**
+         * @brief Returns FileSize as text.
+         * @param _size File size.
+         * @param _unit File size unit.
+         * @return FileSize as text, e.g. 50MiB
+         */
+        static std::string toString(std::intmax_t _size, SizeUnit _unit) {
+            std::string unit;
+            switch (_unit) {
+                case SizeUnit::KB:
+                    unit = "KB";
+                    break;
+                case SizeUnit::KiB:
+                    unit = "KiB";
+                    break;
+                case SizeUnit::MB:
+                    unit = "MB";
+                    break;
+                case SizeUnit::MiB:
+                    unit = "MiB";
+                    break;
+                case SizeUnit::GB:
+                    unit = "GB";
+                    break;
+                case SizeUnit::GiB:
+                    unit = "GiB";
+                    break;
+                case SizeUnit::B:
+                default:
+                    unit = "B";
+                    break;
+            }
+
+            return std::to_string(_size).append(unit);
+        }
+
+        /**
+         * @brief Converts text file size format to class format convention.
+         * @param _fileSize File size format as text.
+         *
+         * Expected format: NU,
+         * where
+         *  - N is std::intmax_t
+         *  - U is SizeUnit as text
+         *
+         * Example: 50MB, 100KiB
+         */
+        static std::optional<FileSize> parseFileSize(const std::string& _fileSize) {
+            FileSize result;
+
+            try {
+                // First: check if text has file size as digit.
+                std::size_t it = 0;
+                for (it = 0; it < _fileSize.size(); it++) {
+                    if (!std::isdigit(_fileSize.at(it))) {
+                        break;
+                    }
+                }
+
+                // Second: check if text has file size unit.
+                if (it > 0 && it < _fileSize.size()) {
+                    int size = std::stoi(_fileSize.substr(0, it));
+                    if (size <= 0) {
+                        return std::nullopt;
+                    }
+
+                    result.size = size;
+                    std::string unit = _fileSize.substr(it);
+
+                    if (unit == "B") {
+                        result.unit = SizeUnit::B;
+                    } else if (unit == "KB") {
+                        result.unit = SizeUnit::KB;
+                    } else if (unit == "KiB") {
+                        result.unit = SizeUnit::KiB;
+                    } else if (unit == "MB") {
+                        result.unit = SizeUnit::MB;
+                    } else if (unit == "MiB") {
+                        result.unit = SizeUnit::MiB;
+                    } else if (unit == "GB") {
+                        result.unit = SizeUnit::GB;
+                    } else if (unit == "GiB") {
+                        result.unit = SizeUnit::GiB;
+                    } else {
+                        return std::nullopt;
+                    }
+                }
+
+                return result;
+            } catch (const std::exception& _ex) {
+                std::cerr << "logcplus: Cannot parse file size, reason: " << _ex.what() << std::endl;
+                return std::nullopt;
+            }
+        }
+
+        std::uintmax_t size;
+        SizeUnit unit;
+    } filesize_t;
+
+    /**
+     * @brief
+     * The DirectoryWatcher class is a basic directory watcher (extension for the logger class). We can define max
+     * file "alive" time and filename pattern. Removes all files (or matching pattern) in specified directory path.
+     */
+    class DirectoryWatcher {
+        PreciseTimer timer_;
+        const char* filePattern_; // Optional filename pattern.
+        unsigned long long fileExpiration_; // File modification time expiration (milliseconds). After this value we should remove pattern files.
+        std::string logDirectory_; // Directory to watch.
+        std::atomic<std::uint64_t> removedFiles_{0}; // Number of removed files.
+
+    public:
+        ~DirectoryWatcher() {
+            // Stop timer if was not stopped yet.
+            stop();
+        }
+
+        /**
+         * @brief Starts directory watcher.
+         * @param _logDirectory The log directory.
+         * @param _fileExpirationMillis The files expiration time (we checking for last modification time) in milliseconds.
+         * @param _filePattern The file pattern (optional, can be empty). We can choose which files in the directory will be removed.
+         * @param _timerInterval The Watcher check interval, default: every 1 hour.
+         */
+        void start(const std::string& _logDirectory, const unsigned long long _fileExpirationMills, const char* _filePattern = "",
+                   const unsigned long long _timerInterval = Timer<>::Milliseconds.HOUR) {
+            if (!timer_.isRunning()) {
+                logDirectory_ = _logDirectory;
+                fileExpiration_ = _fileExpirationMills;
+                filePattern_ = _filePattern;
+
+                // First call without any delay.
+                removeOldLogFiles();
+
+                if (!timer_.isRunning()) {
+                    timer_.startInterval(std::chrono::milliseconds(_timerInterval), [=] {
+                        removeOldLogFiles();
+                    });
+                }
+            }
+        }
+
+        /**
+         * @brief Stops directory watcher.
+         */
+        void stop() {
+            if (timer_.isRunning()) {
+                timer_.stop();
+            }
+        }
+
+        /**
+         * @brief Number of log files removed since the watcher was created.
+         */
+        std::uint64_t removedFiles() const {
+            return removedFiles_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Removes old log files. Called by local watcher timer with specified intervals.
+         */
+        void removeOldLogFiles() {
+            std::vector<std::filesystem::path> filesToRemove = filesOlderThan(logDirectory_, std::chrono::milliseconds(fileExpiration_),
+                                                                              filePattern_);
+
+            try {
+                // Remove all files older than mFileExpiration
+                for (const auto& file: filesToRemove) {
+                    if (std::filesystem::remove(file)) {
+                        removedFiles_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            } catch (const std::exception& ex) {
+                std::cerr << "logcplus: Unexpected error while deleting file " << ex.what() << std::endl;
+            }
+        }
+
+        /**
+         * @brief Checks file modification time with specified limit.
+         * @param _path File path (filename).
+         * @param _limit Expected last modification time.
+         */
+        template<typename Rep, typename Period>
+        bool isFileOlderThan(const std::filesystem::path& _path, const std::chrono::duration<Rep, Period> _limit) const {
+            auto now = std::filesystem::file_time_type::clock::now();
+            return std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(now - std::filesystem::last_write_time(_path)) > _limit;
+        }
+
+        /**
+         * @brief Checks the all files in the specified directory.
+         * @param _directory The Directory path (filename).
+         * @param _limit Expected last modification time.
+         * @param _fileNameRegex Optional file pattern (e.g. when we need remove only specified files).
+         */
+        template<typename Rep, typename Period>
+        std::vector<std::filesystem::path> filesOlderThan(const std::filesystem::path& _directory, const std::chrono::duration<Rep, Period> _limit,
+                                                          const std::string& _fileNameRegex = "") const {
+            std::vector<std::filesystem::path> result;
+            for (const auto& file: std::filesystem::recursive_directory_iterator(_directory)) {
+                // Check regular expression if defined.
+                // E.g. specified file name.
+                if (!_fileNameRegex.empty()) {
+                    const std::regex fileMatch(_fileNameRegex);
+                    if (!std::regex_match(std::filesystem::path(file.path()).filename().string(), fileMatch)) {
+                        continue;
+                    }
+                }
+
+                // Check last file modification.
+                if (std::filesystem::is_regular_file(file) && isFileOlderThan(file, _limit)) {
+                    result.push_back(file);
+                }
+            }
+
+            return result;
+        }
+    };
+
+    /**
+     * @brief
+     * The FileWatcher class is a extension around logger class. Allows you to create callback if the log
+     * file is more expensive as you thought or reopen file in specified time of day (checkpoint).
+     */
+    class FileWatcher {
+    public:
+        struct FileWatcherSettings;
+
+    private:
+        PreciseTimer timer_;
+        std::shared_ptr<FileWatcherSettings> fileWatcherSettings_;
+        std::function<void()> callback_;
+
+    public:
+        struct FileWatcherSettings {
+            // We can define when the watcher will execute callback method (e.g. specified time of day, it's optional).
+            // The file size limit is checked by the logger itself on every write.
+            std::optional<Date::Time> checkPoint;
+        };
+
+        FileWatcher() : fileWatcherSettings_(std::make_shared<FileWatcherSettings>()) {
+
+        }
+
+        ~FileWatcher() {
+            // Stop timer and remove file handler if was not stopped yet.
+            stop();
+        }
+
+        FileWatcherSettings* settings() const {
+            return fileWatcherSettings_.get();
+        }
+
+        /**
+         * @brief Starts file watcher timer.
+         * @param _callback Callback function.
+         * @param _checkInterval The timer interval in milliseconds, default: 1 min.
+         */
+        void start(std::function<void()> _callback, const unsigned long long _checkInterval = Timer<>::Seconds.SECOND * 60000) {
+            if (!timer_.isRunning()) {
+                callback_ = _callback;
+                timer_.startInterval(std::chrono::milliseconds(_checkInterval), [=] {
+                    isTimeToCallback();
+                });
+            }
+        }
+
+        /**
+         * @brief Stops file watcher timer.
+         */
+        void stop() {
+            if (timer_.isRunning()) {
+                timer_.stop();
+            }
+        }
+
+        /**
+         * @brief Timer callback. Creates a new log file at the checkpoint.
+         */
+        void isTimeToCallback() {
+            Date::Time currTime = Date::currentTime();
+
+            // We check if there is the checkpoint (optional).
+            if (fileWatcherSettings_->checkPoint) {
+                // We skip second part (default watcher works with 1 min intervals).
+                if (fileWatcherSettings_->checkPoint->hour == currTime.hour && fileWatcherSettings_->checkPoint->minute == currTime.minute) {
+                    callback_();
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Log levels (see log level pyramid above).
+     */
+    enum class LogLevel {
+        Debug, Info, Warn, Error, Fatal
+    };
+
+    /**
+     * @brief Returns log level as string, e.g. INFO.
+     */
+    inline std::string_view logLevelAsString(const LogLevel _logLevel) {
+        switch (_logLevel) {
+            case LogLevel::Info:
+                return "INFO";
+            case LogLevel::Warn:
+                return "WARN";
+            case LogLevel::Debug:
+                return "DEBUG";
+            case LogLevel::Error:
+                return "ERROR";
+            case LogLevel::Fatal:
+                return "FATAL";
+            default:
+                return "UNKNOWN";
+        }
+    }
+
+    /**
+     * @brief SlabAllocator is a preallocated pool of fixed-size memory chunks used for long log messages.
+     */
+    class SlabAllocator {
+        std::unique_ptr<char[]> memory_;
+        std::size_t chunks_;
+        RingBuffer<char*> freeChunks_;
+
+    public:
+        static constexpr std::size_t CHUNK_SIZE = 4096;
+
+        /**
+         * @param _chunks Number of preallocated chunks.
+         */
+        explicit SlabAllocator(const std::size_t _chunks)
+            : memory_(std::make_unique<char[]>(_chunks * CHUNK_SIZE)), chunks_(_chunks), freeChunks_(_chunks) {
+            for (std::size_t i = 0; i < _chunks; i++) {
+                freeChunks_.enqueue(memory_.get() + i * CHUNK_SIZE);
+            }
+        }
+
+        /**
+         * @brief Takes a free chunk.
+         * @return Chunk of CHUNK_SIZE bytes or nullptr if all chunks are in use.
+         */
+        char* acquire() {
+            char* chunk;
+            return freeChunks_.tryDequeue(chunk) ? chunk : nullptr;
+        }
+
+        /**
+         * @brief Returns chunk taken by `acquire`.
+         */
+        void release(char* _chunk) {
+            freeChunks_.enqueue(std::move(_chunk));
+        }
+    };
+
+    /**
+     * @brief
+     * LogRecord is a single log message passed from the producer to the queue worker. The payload is stored in the
+     * fixed-size inline buffer. Longer payloads overflow to the slab chunk (or heap when the slab is exhausted or the
+     * payload doesn't fit into the chunk).
+     */
+    class LogRecord {
+        enum class Storage {
+            Inline, Slab, Heap
+        };
+
+        SlabAllocator* slab_; // Optional overflow memory for long payloads.
+        char* data_;
+        std::size_t size_;
+        std::size_t capacity_;
+        Storage storage_;
+
+    public:
+        static constexpr std::size_t INLINE_CAPACITY = 256;
+
+        LogLevel level = LogLevel::Debug;
+        std::chrono::system_clock::time_point timestamp;
+        // False - payload is the formatted log line, true - payload contains packed arguments (see LogArguments)
+        // formatted later by the queue worker.
+        bool deferred = false;
+        // Record belongs to the RecordPool (otherwise it was allocated when the pool was exhausted).
+        bool pooled = false;
+        // Beginning of the message (log arguments) in the formatted payload (eager records only).
+        std::uint32_t messageOffset = 0;
+        // Position of the record copy in the shared memory ring (see SharedMemoryRing).
+        std::uint64_t ringOffset = std::numeric_limits<std::uint64_t>::max();
+        // Monotonic time of the log call, set only when the latency is measured (see Logger::setLatencyStatistics).
+        std::chrono::steady_clock::time_point enqueueTime;
+
+        /*
+         * Message - log message written to the sinks
+         * Backtrace - message below the log level kept in the backtrace buffer (see Logger::setBacktraceSize)
+         * DumpBacktrace - request to write the backtrace buffer
+         */
+        enum class Kind : std::uint8_t {
+            Message, Backtrace, DumpBacktrace
+        };
+
+        Kind kind = Kind::Message;
+
+        /**
+         * @brief Orders records by timestamp (used to merge per thread queues).
+         */
+        struct TimestampLess {
+            bool operator()(const LogRecord* _lhs, const LogRecord* _rhs) const {
+                return _lhs->timestamp < _rhs->timestamp;
+            }
+        };
+
+        explicit LogRecord(SlabAllocator* _slab = nullptr)
+            : slab_(_slab), data_(inlineData_), size_(0), capacity_(INLINE_CAPACITY), storage_(Storage::Inline) {
+
+        }
+
+        LogRecord(const LogRecord&) = delete;
+        LogRecord& operator=(const LogRecord&) = delete;
+
+        ~LogRecord() {
+            releaseOverflow();
+        }
+
+        void setSlabAllocator(SlabAllocator* _slab) {
+            slab_ = _slab;
+        }
+
+        /**
+         * @brief Appends data to the payload.
+         */
+        void append(const char* _data, const std::size_t _size) {
+            if (size_ + _size > capacity_) {
+                grow(size_ + _size);
+            }
+
+            std::memcpy(data_ + size_, _data, _size);
+            size_ += _size;
+        }
+
+        void append(const std::string_view _data) {
+            append(_data.data(), _data.size());
+        }
+
+        void push_back(const char _character) {
+            append(&_character, 1);
+        }
+
+        std::string_view payload() const {
+            return std::string_view(data_, size_);
+        }
+
+        /**
+         * @brief Clears the payload and metadata, overflow memory is released.
+         */
+        void clear() {
+            releaseOverflow();
+            size_ = 0;
+            level = LogLevel::Debug;
+            deferred = false;
+            messageOffset = 0;
+            ringOffset = std::numeric_limits<std::uint64_t>::max();
+            enqueueTime = std::chrono::steady_clock::time_point();
+            kind = Kind::Message;
+        }
+
+    private:
+        void grow(const std::size_t _required) {
+            std::size_t capacity = std::max(capacity_ * 2, _required);
+            char* data = nullptr;
+            Storage storage = Storage::Heap;
+
+            if (storage_ == Storage::Inline && capacity <= SlabAllocator::CHUNK_SIZE && slab_) {
+                if ((data = slab_->acquire())) {
+                    capacity = SlabAllocator::CHUNK_SIZE;
+                    storage = Storage::Slab;
+                }
+            }
+
+            if (!data) {
+                data = new char[capacity];
+            }
+
+            std::memcpy(data, data_, size_);
+            releaseOverflow();
+
+            data_ = data;
+            capacity_ = capacity;
+            storage_ = storage;
+        }
+
+        void releaseOverflow() {
+            if (storage_ == Storage::Slab) {
+                slab_->release(data_);
+            } else if (storage_ == Storage::Heap) {
+                delete[] data_;
+            }
+
+            data_ = inlineData_;
+            capacity_ = INLINE_CAPACITY;
+            storage_ = Storage::Inline;
+        }
+
+        char inlineData_[INLINE_CAPACITY];
+    };
+
+    /**
+     * @brief
+     * RecordPool is a pool of preallocated log records. Producers take a record, fill it in place and the queue worker
+     * returns it to the pool, so the steady state logging doesn't allocate. When the pool is exhausted the records are
+     * allocated on the heap.
+     */
+    class RecordPool {
+        SlabAllocator slab_;
+        std::unique_ptr<LogRecord[]> records_;
+        RingBuffer<LogRecord*> freeRecords_;
+
+    public:
+        /**
+         * @param _records Number of preallocated records.
+         * @param _slabChunks Number of preallocated chunks for long messages.
+         */
+        RecordPool(const std::size_t _records, const std::size_t _slabChunks)
+            : slab_(_slabChunks), records_(std::make_unique<LogRecord[]>(_records)), freeRecords_(_records) {
+            for (std::size_t i = 0; i < _records; i++) {
+                records_[i].setSlabAllocator(&slab_);
+                records_[i].pooled = true;
+                freeRecords_.enqueue(&records_[i]);
+            }
+        }
+
+        RecordPool(const RecordPool&) = delete;
+        RecordPool& operator=(const RecordPool&) = delete;
+
+        /**
+         * @brief Takes an empty record.
+         */
+        LogRecord* acquire() {
+            LogRecord* record;
+            if (freeRecords_.tryDequeue(record)) {
+                return record;
+            }
+
+            return new LogRecord(&slab_);
+        }
+
+        /**
+         * @brief Returns record taken by `acquire`.
+         */
+        void release(LogRecord* _record) {
+            if (_record->pooled) {
+                _record->clear();
+                freeRecords_.enqueue(std::move(_record));
+            } else {
+                delete _record;
+            }
+        }
+    };
+
+    /**
+     * @brief
+     * LogArguments formats log arguments without temporary strings (`std::to_chars` to the stack buffer). Arguments
+     * can be formatted eagerly or serialized to the compact binary form (type tag + raw value) on the producer thread
+     * and formatted later on the queue worker thread. Both ways give the same output as `std::to_string`.
+     *
+     * Output can be any type with `append(const char*, std::size_t)` and `push_back(char)`, e.g. std::string or LogRecord.
+     */
+    class LogArguments {
+    public:
+        enum class Type : std::uint8_t {
+            Int, UInt, Double, LongDouble, String
+        };
+
+        /**
+         * @brief Appends formatted arguments, every argument is prefixed with a space.
+         * @param _output Output text.
+         * @param _args Log message parameters.
+         */
+        template<typename Output, typename ...Args>
+        static void concatenate(Output& _output, const Args& ..._args) {
+            int unpack[]{0, (_output.push_back(' '), formatArgument(_output, _args), 0)...};
+            static_cast<void>(unpack);
+        }
+
+        /**
+         * @brief Appends packed arguments to the buffer.
+         * @param _buffer Output buffer.
+         * @param _args Log message parameters.
+         */
+        template<typename Output, typename ...Args>
+        static void pack(Output& _buffer, const Args& ..._args) {
+            int unpack[]{0, (packArgument(_buffer, _args), 0)...};
+            static_cast<void>(unpack);
+        }
+
+        /**
+         * @brief Splits packed arguments into the leading string argument (e.g. message format) and the rest.
+         * @param _buffer Packed arguments.
+         * @param _text Output leading string.
+         * @param _rest Output remaining packed arguments.
+         * @return False if the first argument is not a string.
+         */
+        static bool splitLeadingString(const std::string_view _buffer, std::string_view& _text, std::string_view& _rest) {
+            if (_buffer.size() < 1 + sizeof(std::uint32_t) || static_cast<Type>(_buffer[0]) != Type::String) {
+                return false;
+            }
+
+            std::size_t offset = 1;
+            auto length = read<std::uint32_t>(_buffer, offset);
+            _text = _buffer.substr(offset, length);
+            _rest = _buffer.substr(offset + length);
+
+            return true;
+        }
+
+        /**
+         * @brief Formats packed arguments, every argument is prefixed with a space.
+         * @param _buffer Packed arguments.
+         * @param _output Output text, formatted arguments are appended at the end.
+         */
+        template<typename Output>
+        static void format(const std::string_view _buffer, Output& _output) {
+            std::size_t offset = 0;
+            while (offset < _buffer.size()) {
+                auto type = static_cast<Type>(_buffer[offset++]);
+                _output.push_back(' ');
+
+                switch (type) {
+                    case Type::Int:
+                        appendNumber(_output, read<std::int64_t>(_buffer, offset));
+                        break;
+                    case Type::UInt:
+                        appendNumber(_output, read<std::uint64_t>(_buffer, offset));
+                        break;
+                    case Type::Double:
+                        appendNumber(_output, read<double>(_buffer, offset));
+                        break;
+                    case Type::LongDouble:
+                        appendNumber(_output, read<long double>(_buffer, offset));
+                        break;
+                    case Type::String:
+                    default: {
+                        auto length = read<std::uint32_t>(_buffer, offset);
+                        _output.append(_buffer.data() + offset, length);
+                        offset += length;
+                        break;
+                    }
+                }
+            }
+        }
+
+    private:
+        /**
+         * @brief Formats number like `std::to_string` (floating point numbers with fixed 6 digits precision).
+         */
+        template<typename Output, typename T>
+        static void appendNumber(Output& _output, const T _value) {
+            char buffer[512];
+            std::to_chars_result result;
+
+            if constexpr (std::is_floating_point_v<T>) {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), _value, std::chars_format::fixed, 6);
+            } else {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), _value);
+            }
+
+            if (result.ec == std::errc()) {
+                _output.append(buffer, static_cast<std::size_t>(result.ptr - buffer));
+            } else {
+                std::string text = std::to_string(_value);
+                _output.append(text.data(), text.size());
+            }
+        }
+
+        template<typename Output, typename T>
+        static void write(Output& _buffer, const Type _type, const T _value) {
+            _buffer.push_back(static_cast<char>(_type));
+            _buffer.append(reinterpret_cast<const char*>(&_value), sizeof(T));
+        }
+
+        template<typename T>
+        static T read(const std::string_view _buffer, std::size_t& _offset) {
+            T value;
+            std::memcpy(&value, _buffer.data() + _offset, sizeof(T));
+            _offset += sizeof(T);
+
+            return value;
+        }
+
+        template<typename Output>
+        static void writeString(Output& _buffer, const std::string_view _value) {
+            write(_buffer, Type::String, static_cast<std::uint32_t>(_value.size()));
+            _buffer.append(_value.data(), _value.size());
+        }
+
+        template<typename Output, typename T>
+        static void formatArgument(Output& _output, const T& _value) {
+            if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                appendNumber(_output, static_cast<std::int64_t>(_value));
+            } else if constexpr (std::is_integral_v<T>) {
+                appendNumber(_output, static_cast<std::uint64_t>(_value));
+            } else if constexpr (std::is_same_v<T, long double>) {
+                appendNumber(_output, _value);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                appendNumber(_output, static_cast<double>(_value));
+            } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                std::string_view text(_value);
+                _output.append(text.data(), text.size());
+            } else {
+                // Unknown types (user defined `to_string`).
+                using ::to_string;
+                using std::to_string;
+                std::string text = to_string(_value);
+                _output.append(text.data(), text.size());
+            }
+        }
+
+        template<typename Output, typename T>
+        static void packArgument(Output& _buffer, const T& _value) {
+            if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                write(_buffer, Type::Int, static_cast<std::int64_t>(_value));
+            } else if constexpr (std::is_integral_v<T>) {
+                write(_buffer, Type::UInt, static_cast<std::uint64_t>(_value));
+            } else if constexpr (std::is_same_v<T, long double>) {
+                write(_buffer, Type::LongDouble, _value);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                write(_buffer, Type::Double, static_cast<double>(_value));
+            } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                writeString(_buffer, std::string_view(_value));
+            } else {
+                // Unknown types are formatted eagerly (user defined `to_string`).
+                using ::to_string;
+                using std::to_string;
+                writeString(_buffer, to_string(_value));
+            }
+        }
+    };
+
+    /**
+     * @brief FileCompressor compresses rotated log files (requires zlib, see LOGCPLUS_WITH_ZLIB).
+     */
+    class FileCompressor {
+    public:
+        /**
+         * @brief Checks if the library was built with the gzip support.
+         */
+        static constexpr bool isGzipAvailable() {
+#ifdef LOGCPLUS_WITH_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Compresses the file to `<file>.gz` and removes the original. Data is written to `<file>.gz.tmp` which is
+         * atomically renamed when complete, so there is never a partially written `.gz` file.
+         * @param _path Path to the file.
+         * @return True if the file was compressed.
+         */
+        static bool gzip(const std::filesystem::path& _path) {
+#ifdef LOGCPLUS_WITH_ZLIB
+            std::string compressedPath = _path.string() + ".gz";
+            std::string temporaryPath = compressedPath + ".tmp";
+
+            std::ifstream input(_path, std::ios::binary);
+            gzFile output = gzopen(temporaryPath.c_str(), "wb6");
+            if (!input || !output) {
+                std::cerr << "logcplus: Cannot compress the log file " << _path << std::endl;
+                if (output) {
+                    gzclose(output);
+                    std::filesystem::remove(temporaryPath);
+                }
+
+                return false;
+            }
+
+            std::array<char, 65536> buffer;
+            bool success = true;
+            while (success && input) {
+                input.read(buffer.data(), buffer.size());
+                if (auto read = static_cast<unsigned>(input.gcount()); read > 0) {
+                    success = gzwrite(output, buffer.data(), read) == static_cast<int>(read);
+                }
+            }
+
+            success = gzclose(output) == Z_OK && success && input.eof();
+            input.close();
+
+            std::error_code errorCode;
+            if (success) {
+                std::filesystem::rename(temporaryPath, compressedPath, errorCode);
+            }
+
+            if (!success || errorCode) {
+                std::cerr << "logcplus: Cannot compress the log file " << _path << std::endl;
+                std::filesystem::remove(temporaryPath, errorCode);
+                return false;
+            }
+
+            std::filesystem::remove(_path, errorCode);
+            return true;
+#else
+            static_cast<void>(_path);
+            return false;
+#endif
+        }
+    };
+
+    /**
+     * @brief TaskWorker runs tasks (e.g. closing rotated log files) on the background thread started on demand.
+     */
+    class TaskWorker {
+        ConcurrentQueue<std::function<void()>> tasks_;
+        std::thread worker_;
+        std::mutex workerMutex_;
+        const bool lowPriority_; // Background thread runs with the lowest scheduling priority (nice 19).
+
+    public:
+        explicit TaskWorker(const bool _lowPriority = false) : lowPriority_(_lowPriority) {
+
+        }
+
+        TaskWorker(const TaskWorker&) = delete;
+        TaskWorker& operator=(const TaskWorker&) = delete;
+
+        ~TaskWorker() {
+            stop();
+        }
+
+        /**
+         * @brief Schedules the task.
+         * @param _task Task to run on the background thread.
+         */
+        void submit(std::function<void()> _task) {
+            std::lock_guard<std::mutex> lock(workerMutex_);
+            if (!worker_.joinable()) {
+                worker_ = std::thread([this]() {
+                    if (lowPriority_) {
+                        ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+                    }
+
+                    // Empty task stops the worker.
+                    while (auto task = tasks_.dequeue()) {
+                        task();
+                    }
+                });
+            }
+
+            tasks_.enqueue(std::move(_task));
+        }
+
+        /**
+         * @brief Runs all scheduled tasks and stops the background thread.
+         */
+        void stop() {
+            std::lock_guard<std::mutex> lock(workerMutex_);
+            if (worker_.joinable()) {
+                tasks_.enqueue(nullptr);
+                worker_.join();
+            }
+        }
+    };
+
+    /**
+     * @brief
+     * LogFormatter renders the log record as a single line (without new line). Formatters are called only by the queue
+     * worker thread, every record is formatted once per formatter no matter how many sinks share it.
+     */
+    class LogFormatter {
+    public:
+        virtual ~LogFormatter() = default;
+
+        /**
+         * @brief Appends formatted log line to the output.
+         * @param _record Log record.
+         * @param _output Output text.
+         */
+        virtual void format(const LogRecord& _record, std::string& _output) = 0;
+
+    protected:
+        /**
+         * @brief Appends the record message (log arguments), every argument is prefixed with a space.
+         */
+        static void appendMessage(const LogRecord& _record, std::string& _output) {
+            if (_record.deferred) {
+                LogArguments::format(_record.payload(), _output);
+            } else {
+                _output.append(_record.payload().substr(_record.messageOffset));
+            }
+        }
+    };
+
+    /**
+     * @brief Default log line format: `[LEVEL] YYYY-MM-DD HH:MM:SS - message`.
+     */
+    class DefaultFormatter : public LogFormatter {
+        std::atomic<TimestampCache::Precision> precision_;
+        TimestampCache timestampCache_; // Renders timestamps of the deferred records.
+
+    public:
+        explicit DefaultFormatter(const TimestampCache::Precision _precision = TimestampCache::Precision::Seconds)
+            : precision_(_precision), timestampCache_(_precision) {
+
+        }
+
+        void setPrecision(const TimestampCache::Precision _precision) {
+            precision_.store(_precision, std::memory_order_relaxed);
+        }
+
+        void format(const LogRecord& _record, std::string& _output) override {
+            // Eager records are already formatted by the caller.
+            if (!_record.deferred) {
+                _output.append(_record.payload());
+                return;
+            }
+
+            timestampCache_.setPrecision(precision_.load(std::memory_order_relaxed));
+            _output.append("[").append(logLevelAsString(_record.level)).append("] ").append(timestampCache_.format(_record.timestamp)).append(" -");
+            appendMessage(_record, _output);
+        }
+    };
+
+    /**
+     * @brief
+     * BinaryFormatter writes records in the compact binary form instead of text (see BinaryLogDecoder). Leading string
+     * arguments (message formats) are interned: the string is written once as a definition entry and then referenced by
+     * id. Every entry ends with the new line byte appended by the logger:
+     *
+     *  definition: u8 kind (0), u32 id, u32 length, string bytes, '\n'
+     *  record:     u8 kind (1), u8 level, i64 timestamp (microseconds since epoch), u32 format id (NO_FORMAT if none),
+     *              u32 arguments length, packed arguments (see LogArguments), '\n'
+     *
+     * Numbers are written in the host byte order. Eager records keep their message as a single string argument. The
+     * string table is bound to a single file, so the formatter shouldn't be shared between sinks. Leading strings aren't
+     * necessarily constant (e.g. `logger->info(name, "connected")`), so the table is limited: once it's full, new leading
+     * strings are written inline as the first argument of the record (NO_FORMAT).
+     */
+    class BinaryFormatter : public LogFormatter {
+        std::map<std::string, std::uint32_t, std::less<>> formats_;
+        std::size_t maxFormats_;
+        std::string arguments_;
+
+    public:
+        static constexpr char MAGIC[8] = {'L', 'O', 'G', 'C', 'P', 'B', 'I', 'N'};
+        static constexpr std::uint8_t DEFINITION = 0;
+        static constexpr std::uint8_t RECORD = 1;
+        static constexpr std::uint32_t NO_FORMAT = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::size_t DEFAULT_MAX_FORMATS = 4096;
+
+        /**
+         * @param _maxFormats Maximum number of interned strings per file.
+         */
+        explicit BinaryFormatter(const std::size_t _maxFormats = DEFAULT_MAX_FORMATS) : maxFormats_(_maxFormats) {
+
+        }
+
+        /**
+         * @brief Forgets interned strings (they are defined again in the new file).
+         */
+        void reset() {
+            formats_.clear();
+        }
+
+        void format(const LogRecord& _record, std::string& _output) override {
+            std::string_view format, arguments;
+            arguments_.clear();
+
+            if (!_record.deferred) {
+                // Skip the space in front of the message (formatting adds it back).
+                if (std::string_view message = _record.payload().substr(_record.messageOffset); !message.empty()) {
+                    LogArguments::pack(arguments_, message.substr(1));
+                }
+                arguments = arguments_;
+            } else if (!LogArguments::splitLeadingString(_record.payload(), format, arguments)) {
+                arguments = _record.payload();
+            }
+
+            std::uint32_t formatId = NO_FORMAT;
+            if (!format.empty()) {
+                if (auto interned = formats_.find(format); interned != formats_.end()) {
+                    formatId = interned->second;
+                } else if (formats_.size() >= maxFormats_) {
+                    // Leading string stays in the packed arguments.
+                    arguments = _record.payload();
+                } else {
+                    formatId = static_cast<std::uint32_t>(formats_.size());
+                    formats_.emplace(format, formatId);
+
+                    _output.push_back(static_cast<char>(DEFINITION));
+                    append(_output, formatId);
+                    append(_output, static_cast<std::uint32_t>(format.size()));
+                    _output.append(format);
+                    _output.push_back('\n');
+                }
+            }
+
+            _output.push_back(static_cast<char>(RECORD));
+            _output.push_back(static_cast<char>(_record.level));
+            append(_output, static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(_record.timestamp.time_since_epoch()).count()));
+            append(_output, formatId);
+            append(_output, static_cast<std::uint32_t>(arguments.size()));
+            _output.append(arguments);
+        }
+
+    private:
+        template<typename T>
+        static void append(std::string& _output, const T _value) {
+            _output.append(reinterpret_cast<const char*>(&_value), sizeof(T));
+        }
+    };
+
+    /**
+     * @brief
+     * BinaryLogDecoder converts binary logs (see BinaryFormatter) back to the default text format
+     * `[LEVEL] YYYY-MM-DD HH:MM:SS - message`. Timestamps are rendered in the local time zone.
+     */
+    class BinaryLogDecoder {
+    public:
+        /**
+         * @brief Decodes the binary log.
+         * @param _input Binary log.
+         * @param _output Text output (one line per record).
+         * @param _precision Timestamp precision.
+         * @return False if the input is not a binary log or it's truncated / corrupted (complete records are decoded).
+         */
+        static bool decode(std::istream& _input, std::ostream& _output,
+                           const TimestampCache::Precision _precision = TimestampCache::Precision::Seconds) {
+            char magic[sizeof(BinaryFormatter::MAGIC)];
+            if (!_input.read(magic, sizeof(magic)) || std::memcmp(magic, BinaryFormatter::MAGIC, sizeof(magic)) != 0) {
+                return false;
+            }
+
+            std::vector<std::string> formats;
+            TimestampCache timestampCache(_precision);
+            std::string arguments, line;
+
+            for (int kind; (kind = _input.get()) != std::char_traits<char>::eof();) {
+                if (kind == BinaryFormatter::DEFINITION) {
+                    std::uint32_t id, length;
+                    if (!read(_input, id) || !read(_input, length)) {
+                        return false;
+                    }
+
+                    if (id >= formats.size()) {
+                        formats.resize(static_cast<std::size_t>(id) + 1);
+                    }
+
+                    formats[id].resize(length);
+                    if (!_input.read(formats[id].data(), length)) {
+                        return false;
+                    }
+                } else if (kind == BinaryFormatter::RECORD) {
+                    std::uint8_t level;
+                    std::int64_t timestamp;
+                    std::uint32_t formatId, length;
+                    if (!read(_input, level) || !read(_input, timestamp) || !read(_input, formatId) || !read(_input, length)) {
+                        return false;
+                    }
+
+                    arguments.resize(length);
+                    if (!_input.read(arguments.data(), length)) {
+                        return false;
+                    }
+
+                    line.clear();
+                    line.append("[").append(logLevelAsString(static_cast<LogLevel>(level))).append("] ")
+                        .append(timestampCache.format(std::chrono::system_clock::time_point(std::chrono::microseconds(timestamp))))
+                        .append(" -");
+                    if (formatId != BinaryFormatter::NO_FORMAT) {
+                        if (formatId >= formats.size()) {
+                            return false;
+                        }
+
+                        line.append(" ").append(formats[formatId]);
+                    }
+                    LogArguments::format(arguments, line);
+                    _output << line << '\n';
+                } else {
+                    return false;
+                }
+
+                if (_input.get() != '\n') {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        template<typename T>
+        static bool read(std::istream& _input, T& _value) {
+            return static_cast<bool>(_input.read(reinterpret_cast<char*>(&_value), sizeof(T)));
+        }
+    };
+
+    /**
+     * @brief
+     * SharedMemoryRing keeps a copy of every queued record in the file-backed shared memory (e.g. /dev/shm), so messages
+     * not written by the queue worker survive the process death (SIGKILL, OOM kill) and can be recovered (see
+     * `recover` and the logcplusRecover tool).
+     *
+     * Producers reserve entries with CAS on the head offset and commit them with the entry state. The queue worker marks
+     * entries consumed once they're written to the sinks and advances the consumed offset over the consumed prefix (the
+     * space is zeroed for reuse). Messages are recovered at least once: entries written right before the death may be
+     * both in the log and in the ring. If the ring is full the record is not copied (producers never wait), the number
+     * of such records is kept in the header.
+     *
+     *  header: magic, u32 version, u32 owner pid, u64 capacity, u64 head, u64 consumed, u64 lost
+     *  entry:  u32 state, u32 entry size (aligned to ENTRY_ALIGNMENT bytes), u32 payload size, u8 level, u8 deferred,
+     *          u16 reserved, i64 timestamp (microseconds since epoch), payload
+     *
+     * Entries never wrap, the rest of the ring is filled with the padding entry. Entry sizes are multiples of
+     * ENTRY_ALIGNMENT (not smaller than the entry header), so the padding always has room for the entry header.
+     */
+    class SharedMemoryRing {
+    public:
+        static constexpr char MAGIC[8] = {'L', 'O', 'G', 'C', 'P', 'S', 'H', 'M'};
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr std::uint64_t NO_OFFSET = std::numeric_limits<std::uint64_t>::max();
+        static constexpr std::size_t DEFAULT_CAPACITY = 16 * 1024 * 1024;
+
+    private:
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t pid;
+            std::uint64_t capacity;
+            std::uint64_t head; // Reserved bytes (producers).
+            std::uint64_t consumed; // Consumed bytes (queue worker).
+            std::uint64_t lost; // Records not copied because the ring was full.
+        };
+
+        struct Entry {
+            std::uint32_t state;
+            std::uint32_t size;
+            std::uint32_t payloadSize;
+            std::uint8_t level;
+            std::uint8_t deferred;
+            std::uint16_t reserved;
+            std::int64_t timestamp;
+        };
+
+        enum State : std::uint32_t {
+            Reserved = 0, Committed = 1, Consumed = 2, Padding = 3
+        };
+
+        static constexpr std::uint64_t ENTRY_ALIGNMENT = 32;
+        static_assert(sizeof(Entry) <= ENTRY_ALIGNMENT, "Entry header must fit into the smallest padding");
+
+        std::filesystem::path path_;
+        int fd_;
+        char* mapping_;
+        std::size_t mappingSize_;
+        Header* header_;
+        char* data_;
+        std::uint64_t mask_;
+
+        SharedMemoryRing() : fd_(-1), mapping_(nullptr), mappingSize_(0), header_(nullptr), data_(nullptr), mask_(0) {
+
+        }
+
+    public:
+        SharedMemoryRing(const SharedMemoryRing&) = delete;
+        SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+        ~SharedMemoryRing() {
+            if (mapping_) {
+                ::munmap(mapping_, mappingSize_);
+            }
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+        }
+
+        /**
+         * @brief Default ring file of the process (/dev/shm or the temporary directory if not available).
+         */
+        static std::filesystem::path defaultPath() {
+            std::error_code errorCode;
+            std::filesystem::path directory = std::filesystem::is_directory("/dev/shm", errorCode) ? std::filesystem::path("/dev/shm")
+                                                                                                   : std::filesystem::temp_directory_path();
+            return directory / ("logcplus-" + std::to_string(::getpid()) + ".ring");
+        }
+
+        /**
+         * @brief Creates the ring file (the existing file is replaced).
+         * @param _path Ring file.
+         * @param _capacity Ring capacity in bytes (rounded up to the power of two).
+         * @return Nullptr if the file cannot be created.
+         */
+        static std::unique_ptr<SharedMemoryRing> create(const std::filesystem::path& _path, const std::size_t _capacity) {
+            std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing());
+            std::uint64_t capacity = 4096;
+            while (capacity < _capacity) {
+                capacity <<= 1;
+            }
+
+            ring->path_ = _path;
+            ring->mappingSize_ = sizeof(Header) + capacity;
+            ring->fd_ = ::open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (ring->fd_ < 0 || ::ftruncate(ring->fd_, static_cast<off_t>(ring->mappingSize_)) != 0) {
+                std::cerr << "logcplus: Cannot create the shared memory ring " << _path << ": " << std::strerror(errno) << std::endl;
+                return nullptr;
+            }
+
+            void* mapping = ::mmap(nullptr, ring->mappingSize_, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd_, 0);
+            if (mapping == MAP_FAILED) {
+                std::cerr << "logcplus: Cannot map the shared memory ring " << _path << ": " << std::strerror(errno) << std::endl;
+                return nullptr;
+            }
+
+            ring->mapping_ = static_cast<char*>(mapping);
+            ring->header_ = reinterpret_cast<Header*>(ring->mapping_);
+            ring->data_ = ring->mapping_ + sizeof(Header);
+            ring->mask_ = capacity - 1;
+
+            ring->header_->version = VERSION;
+            ring->header_->pid = static_cast<std::uint32_t>(::getpid());
+            ring->header_->capacity = capacity;
+            // Magic is written last, the ring is valid from now on.
+            std::memcpy(ring->header_->magic, MAGIC, sizeof(MAGIC));
+
+            return ring;
+        }
+
+        const std::filesystem::path& path() const {
+            return path_;
+        }
+
+        std::size_t capacity() const {
+            return static_cast<std::size_t>(mask_ + 1);
+        }
+
+        /**
+         * @brief Removes the ring file (the mapping stays valid).
+         */
+        void unlink() {
+            std::error_code errorCode;
+            std::filesystem::remove(path_, errorCode);
+        }
+
+        /**
+         * @brief Copies the record to the ring (called by producers).
+         * @return Offset of the entry or NO_OFFSET if the ring is full.
+         */
+        std::uint64_t write(const LogRecord& _record) {
+            std::string_view payload = _record.payload();
+            std::uint64_t size = (sizeof(Entry) + payload.size() + ENTRY_ALIGNMENT - 1) & ~(ENTRY_ALIGNMENT - 1);
+            std::uint64_t capacity = mask_ + 1;
+            if (size > capacity / 2) {
+                __atomic_fetch_add(&header_->lost, 1, __ATOMIC_RELAXED);
+                return NO_OFFSET;
+            }
+
+            // Entry never wraps, the rest of the ring is filled with padding then.
+            std::uint64_t head = __atomic_load_n(&header_->head, __ATOMIC_RELAXED), padding;
+            do {
+                std::uint64_t position = head & mask_;
+                padding = capacity - position < size ? capacity - position : 0;
+                if (head + padding + size - __atomic_load_n(&header_->consumed, __ATOMIC_ACQUIRE) > capacity) {
+                    __atomic_fetch_add(&header_->lost, 1, __ATOMIC_RELAXED);
+                    return NO_OFFSET;
+                }
+            } while (!__atomic_compare_exchange_n(&header_->head, &head, head + padding + size, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+            if (padding > 0) {
+                auto* entry = reinterpret_cast<Entry*>(data_ + (head & mask_));
+                entry->size = static_cast<std::uint32_t>(padding);
+                __atomic_store_n(&entry->state, Padding, __ATOMIC_RELEASE);
+            }
+
+            std::uint64_t offset = head + padding;
+            auto* entry = reinterpret_cast<Entry*>(data_ + (offset & mask_));
+            entry->size = static_cast<std::uint32_t>(size);
+            entry->payloadSize = static_cast<std::uint32_t>(payload.size());
+            entry->level = static_cast<std::uint8_t>(_record.level);
+            entry->deferred = _record.deferred ? 1 : 0;
+            entry->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(_record.timestamp.time_since_epoch()).count();
+            std::memcpy(reinterpret_cast<char*>(entry) + sizeof(Entry), payload.data(), payload.size());
+            __atomic_store_n(&entry->state, Committed, __ATOMIC_RELEASE);
+
+            return offset;
+        }
+
+        /**
+         * @brief Marks the entry consumed (the record was written or dropped).
+         */
+        void consume(const std::uint64_t _offset) {
+            if (_offset != NO_OFFSET) {
+                __atomic_store_n(&reinterpret_cast<Entry*>(data_ + (_offset & mask_))->state, Consumed, __ATOMIC_RELEASE);
+            }
+        }
+
+        /**
+         * @brief Releases the consumed prefix of the ring (called by the queue worker only).
+         */
+        void advance() {
+            std::uint64_t consumed = __atomic_load_n(&header_->consumed, __ATOMIC_RELAXED);
+            std::uint64_t head = __atomic_load_n(&header_->head, __ATOMIC_ACQUIRE);
+
+            while (consumed < head) {
+                auto* entry = reinterpret_cast<Entry*>(data_ + (consumed & mask_));
+                std::uint32_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+                if (state != Consumed && state != Padding) {
+                    break;
+                }
+
+                // Zeroed space is recognized as not committed if the process dies during the next write.
+                std::uint32_t size = entry->size;
+                std::memset(entry, 0, size);
+                consumed += size;
+            }
+
+            __atomic_store_n(&header_->consumed, consumed, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief Reads the owner process id of the ring file.
+         */
+        static std::optional<pid_t> owner(const std::filesystem::path& _path) {
+            std::ifstream input(_path, std::ios::binary);
+            Header header{};
+            if (!input.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+                return std::nullopt;
+            }
+
+            return static_cast<pid_t>(header.pid);
+        }
+
+        /**
+         * @brief Writes unconsumed records of the ring (e.g. left by the dead process) in the default text format.
+         * @param _path Ring file.
+         * @param _output Text output (one line per record).
+         * @param _precision Timestamp precision of the deferred records.
+         * @return Number of recovered records or nothing if the file is not a valid ring.
+         */
+        static std::optional<std::size_t> recover(const std::filesystem::path& _path, std::ostream& _output,
+                                                  const TimestampCache::Precision _precision = TimestampCache::Precision::Seconds) {
+            std::ifstream input(_path, std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+            if (content.size() < sizeof(Header)) {
+                return std::nullopt;
+            }
+
+            Header header{};
+            std::memcpy(&header, content.data(), sizeof(Header));
+            std::uint64_t capacity = header.capacity;
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || capacity == 0 ||
+                (capacity & (capacity - 1)) != 0 || content.size() < sizeof(Header) + capacity || header.head < header.consumed ||
+                header.head - header.consumed > capacity) {
+                return std::nullopt;
+            }
+
+            const char* data = content.data() + sizeof(Header);
+            DefaultFormatter formatter(_precision);
+            LogRecord record;
+            std::string line;
+            std::size_t recovered = 0;
+
+            for (std::uint64_t offset = header.consumed; offset < header.head;) {
+                Entry entry{};
+                std::memcpy(&entry, data + (offset & (capacity - 1)), sizeof(Entry));
+                // Not committed entry (the process died during the write), the size can't be trusted.
+                if (entry.size < ENTRY_ALIGNMENT || entry.size % ENTRY_ALIGNMENT != 0 || entry.size > header.head - offset) {
+                    break;
+                }
+
+                if (entry.state == Committed && sizeof(Entry) + entry.payloadSize <= entry.size) {
+                    record.clear();
+                    record.level = static_cast<LogLevel>(std::min<std::uint8_t>(entry.level, static_cast<std::uint8_t>(LogLevel::Fatal)));
+                    record.deferred = entry.deferred != 0;
+                    record.timestamp = std::chrono::system_clock::time_point(std::chrono::microseconds(entry.timestamp));
+                    record.append(data + (offset & (capacity - 1)) + sizeof(Entry), entry.payloadSize);
+
+                    line.clear();
+                    formatter.format(record, line);
+                    _output << line << '\n';
+                    recovered++;
+                }
+
+                offset += entry.size;
+            }
+
+            if (header.lost > 0) {
+                std::cerr << "logcplus: " << header.lost << " records were not copied to the full shared memory ring " << _path << std::endl;
+            }
+
+            return recovered;
+        }
+    };
+
+    /**
+     * @brief
+     * LogSink is a log messages destination. Every sink has its own level threshold and formatter (the logger
+     * default formatter if not specified). Sinks are written only by the queue worker thread.
+     */
+    class LogSink {
+        std::atomic<LogLevel> level_;
+        std::shared_ptr<LogFormatter> formatter_;
+
+    public:
+        explicit LogSink(const LogLevel _level = LogLevel::Debug, std::shared_ptr<LogFormatter> _formatter = nullptr)
+            : level_(_level), formatter_(std::move(_formatter)) {
+
+        }
+
+        virtual ~LogSink() = default;
+
+        /**
+         * @brief Messages below this level are not written to the sink.
+         */
+        LogLevel level() const {
+            return level_.load(std::memory_order_relaxed);
+        }
+
+        void setLevel(const LogLevel _level) {
+            level_.store(_level, std::memory_order_relaxed);
+        }
+
+        const std::shared_ptr<LogFormatter>& formatter() const {
+            return formatter_;
+        }
+
+        /**
+         * @brief Writes formatted log lines (every line ends with a new line).
+         * @param _lines Spans of the formatted lines (may be modified by the sink).
+         * @param _count Number of spans.
+         */
+        virtual void write(struct iovec* _lines, std::size_t _count) = 0;
+
+        /**
+         * @brief Makes the written lines durable (called according to the logger sync policy).
+         */
+        virtual void sync() {
+
+        }
+    };
+
+    /**
+     * @brief ConsoleSink writes log messages to the std::cout.
+     */
+    class ConsoleSink : public LogSink {
+    public:
+        using LogSink::LogSink;
+
+        void write(struct iovec* _lines, std::size_t _count) override {
+            for (std::size_t i = 0; i < _count; i++) {
+                std::cout.write(static_cast<const char*>(_lines[i].iov_base), static_cast<std::streamsize>(_lines[i].iov_len));
+            }
+
+            std::cout.flush();
+        }
+    };
+
+#ifdef LOGCPLUS_HAS_IO_URING
+    /**
+     * @brief
+     * IoUring is a minimal io_uring wrapper (raw syscalls, no liburing) used to submit writes with explicit offsets. It's
+     * used by a single thread.
+     */
+    class IoUring {
+        int fd_;
+        unsigned entries_;
+        void* sqRing_;
+        void* cqRing_;
+        std::size_t sqRingSize_;
+        std::size_t cqRingSize_;
+        io_uring_sqe* sqes_;
+        std::size_t sqesSize_;
+        unsigned* sqHead_;
+        unsigned* sqTail_;
+        unsigned* sqMask_;
+        unsigned* sqArray_;
+        unsigned* cqHead_;
+        unsigned* cqTail_;
+        unsigned* cqMask_;
+        io_uring_cqe* cqes_;
+
+    public:
+        IoUring() : fd_(-1), entries_(0), sqRing_(MAP_FAILED), cqRing_(MAP_FAILED), sqRingSize_(0), cqRingSize_(0),
+                    sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)), sqesSize_(0), sqHead_(nullptr), sqTail_(nullptr), sqMask_(nullptr),
+                    sqArray_(nullptr), cqHead_(nullptr), cqTail_(nullptr), cqMask_(nullptr), cqes_(nullptr) {
+
+        }
+
+        IoUring(const IoUring&) = delete;
+        IoUring& operator=(const IoUring&) = delete;
+
+        ~IoUring() {
+            if (sqes_ != MAP_FAILED) {
+                ::munmap(sqes_, sqesSize_);
+            }
+            if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+                ::munmap(cqRing_, cqRingSize_);
+            }
+            if (sqRing_ != MAP_FAILED) {
+                ::munmap(sqRing_, sqRingSize_);
+            }
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+        }
+
+        /**
+         * @brief Creates the ring.
+         * @param _entries Number of submission queue entries.
+         * @return False if io_uring is not supported (or not allowed) by the kernel.
+         */
+        bool initialize(const unsigned _entries) {
+            io_uring_params params{};
+            fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, _entries, &params));
+            if (fd_ < 0) {
+                return false;
+            }
+
+            entries_ = params.sq_entries;
+            sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap) {
+                sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+            }
+
+            sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+            cqRing_ = singleMmap ? sqRing_ : ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+            sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+            if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+                return false;
+            }
+
+            auto* sqRing = static_cast<char*>(sqRing_);
+            auto* cqRing = static_cast<char*>(cqRing_);
+            sqHead_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.head);
+            sqTail_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+            sqMask_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+            sqArray_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+            cqHead_ = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+            cqTail_ = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+            cqMask_ = reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+
+            return true;
+        }
+
+        /**
+         * @brief Submits the vectored write at the given offset.
+         * @return False if the submission failed (the request was not queued).
+         */
+        bool submitWrite(const int _fd, const struct iovec* _buffer, const std::uint64_t _offset, const std::uint64_t _userData) {
+            unsigned tail = *sqTail_;
+            if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= entries_) {
+                return false;
+            }
+
+            unsigned index = tail & *sqMask_;
+            io_uring_sqe* sqe = &sqes_[index];
+            std::memset(sqe, 0, sizeof(io_uring_sqe));
+            sqe->opcode = IORING_OP_WRITEV;
+            sqe->fd = _fd;
+            sqe->addr = reinterpret_cast<std::uint64_t>(_buffer);
+            sqe->len = 1;
+            sqe->off = _offset;
+            sqe->user_data = _userData;
+            sqArray_[index] = index;
+            __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+
+            while (::syscall(__NR_io_uring_enter, fd_, 1, 0, 0, nullptr, 0) < 0) {
+                if (errno != EINTR && errno != EAGAIN) {
+                    // Take the entry back, the kernel did not consume it.
+                    if (__atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) == tail) {
+                        __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+                        return false;
+                    }
+
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Takes the next completion.
+         * @param _userData Output user data of the completed request.
+         * @param _result Output result (written bytes or negative error code).
+         * @param _wait Waits for the completion if none is available.
+         * @return False if there is no completion (and `_wait` is false).
+         */
+        bool complete(std::uint64_t& _userData, int& _result, const bool _wait) {
+            while (true) {
+                unsigned head = *cqHead_;
+                if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                    const io_uring_cqe* cqe = &cqes_[head & *cqMask_];
+                    _userData = cqe->user_data;
+                    _result = cqe->res;
+                    __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+                    return true;
+                }
+
+                if (!_wait) {
+                    return false;
+                }
+
+                if (::syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                    return false;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief
+     * AsyncFileWriter keeps several write buffers in flight (io_uring), so the queue worker formats the next batch while
+     * the previous one is written. Writes use explicit offsets, short writes are resubmitted.
+     *
+     * When io_uring fails (submission or waiting for completions) the writer is marked failed: writes in flight are
+     * still waited for (the completion queue is polled), new writes are refused and the caller writes synchronously.
+     */
+    class AsyncFileWriter {
+        struct Slot {
+            std::string buffer;
+            struct iovec iov{};
+            int fd = -1;
+            std::uint64_t offset = 0;
+            bool inFlight = false;
+        };
+
+        IoUring ring_;
+        std::array<Slot, 4> slots_;
+        std::size_t inFlight_;
+        std::uint64_t failedWrites_; // Writes completed with an error since the last `takeFailedWrites`.
+        bool failed_; // io_uring failed, new writes are refused.
+
+    public:
+        AsyncFileWriter() : inFlight_(0), failedWrites_(0), failed_(false) {
+
+        }
+
+        bool failed() const {
+            return failed_;
+        }
+
+        /**
+         * @brief Returns the number of failed writes and resets it.
+         */
+        std::uint64_t takeFailedWrites() {
+            return std::exchange(failedWrites_, 0);
+        }
+
+        /**
+         * @brief Creates the io_uring instance.
+         * @return False if io_uring is not available.
+         */
+        bool initialize() {
+            return ring_.initialize(static_cast<unsigned>(slots_.size()));
+        }
+
+        /**
+         * @brief Writes the buffer at the given offset. The buffer is swapped with the free (empty) one, so no data is
+         * copied.
+         * @return False if the write was not submitted (the buffer is left untouched).
+         */
+        bool write(const int _fd, const std::uint64_t _offset, std::string& _buffer) {
+            Slot* slot = freeSlot();
+            if (!slot) {
+                return false;
+            }
+
+            slot->buffer.swap(_buffer);
+            if (!submit(*slot, _fd, _offset, 0)) {
+                slot->buffer.swap(_buffer);
+                return false;
+            }
+
+            _buffer.clear();
+            return true;
+        }
+
+        /**
+         * @brief Copies the data and writes it at the given offset.
+         * @return False if the write was not submitted.
+         */
+        bool write(const int _fd, const std::uint64_t _offset, const char* _data, const std::size_t _size) {
+            Slot* slot = freeSlot();
+            if (!slot) {
+                return false;
+            }
+
+            slot->buffer.assign(_data, _size);
+            return submit(*slot, _fd, _offset, 0);
+        }
+
+        /**
+         * @brief Waits until all writes are completed. Buffers and descriptors of the written files can be released then.
+         * @return False if io_uring failed (the writer is not used anymore).
+         */
+        bool drain() {
+            while (inFlight_ > 0) {
+                if (!failed_ && !reap(true)) {
+                    fail("Cannot wait for the log file writes");
+                }
+
+                // The kernel still completes the writes, the completion queue is polled.
+                if (failed_ && !reap(false)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            return !failed_;
+        }
+
+    private:
+        void fail(const char* _message) {
+            if (!failed_) {
+                std::cerr << "logcplus: " << _message << ": " << std::strerror(errno) << ", write(2) is used" << std::endl;
+                failed_ = true;
+            }
+        }
+
+        Slot* freeSlot() {
+            if (failed_) {
+                return nullptr;
+            }
+
+            // Collect completed writes without waiting, wait only if all buffers are in flight.
+            while (reap(false)) {
+            }
+
+            while (inFlight_ == slots_.size()) {
+                if (!reap(true)) {
+                    fail("Cannot wait for the log file writes");
+                    return nullptr;
+                }
+            }
+
+            for (auto& slot: slots_) {
+                if (!slot.inFlight) {
+                    return &slot;
+                }
+            }
+
+            return nullptr;
+        }
+
+        bool submit(Slot& _slot, const int _fd, const std::uint64_t _offset, const std::size_t _written) {
+            _slot.fd = _fd;
+            _slot.offset = _offset;
+            _slot.iov.iov_base = _slot.buffer.data() + _written;
+            _slot.iov.iov_len = _slot.buffer.size() - _written;
+
+            auto index = static_cast<std::uint64_t>(&_slot - slots_.data());
+            if (failed_ || !ring_.submitWrite(_fd, &_slot.iov, _offset + _written, index)) {
+                fail("Cannot submit the log file write");
+                return false;
+            }
+
+            _slot.inFlight = true;
+            inFlight_++;
+            return true;
+        }
+
+        /**
+         * @brief Processes a single completion (resubmits the rest of the short write).
+         */
+        bool reap(const bool _wait) {
+            std::uint64_t index;
+            int result;
+            if (!ring_.complete(index, result, _wait)) {
+                return false;
+            }
+
+            Slot& slot = slots_[index];
+            slot.inFlight = false;
+            inFlight_--;
+
+            auto written = static_cast<std::size_t>(static_cast<char*>(slot.iov.iov_base) - slot.buffer.data());
+            if (result >= 0 && static_cast<std::size_t>(result) < slot.iov.iov_len) {
+                written += static_cast<std::size_t>(result);
+            } else if (result >= 0 || (result != -EINTR && result != -EAGAIN)) {
+                if (result < 0) {
+                    std::cerr << "logcplus: Cannot write to the log file: " << std::strerror(-result) << std::endl;
+                    failedWrites_++;
+                }
+
+                return true;
+            }
+
+            // The rest of the write is written synchronously if it cannot be resubmitted.
+            if (!submit(slot, slot.fd, slot.offset, written) && !writeRest(slot, written)) {
+                failedWrites_++;
+            }
+
+            return true;
+        }
+
+        static bool writeRest(const Slot& _slot, std::size_t _written) {
+            while (_written < _slot.buffer.size()) {
+                ssize_t written = ::pwrite(_slot.fd, _slot.buffer.data() + _written, _slot.buffer.size() - _written,
+                                           static_cast<off_t>(_slot.offset + _written));
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    std::cerr << "logcplus: Cannot write to the log file: " << std::strerror(errno) << std::endl;
+                    return false;
+                }
+
+                _written += static_cast<std::size_t>(written);
+            }
+
+            return true;
+        }
+    };
+#endif
+
+    /**
+     * @brief
+     * FileSink writes log messages directly to the file descriptor opened with O_APPEND. There is no iostream layer in
+     * between and the process wide std::cout is not touched.
+     *
+     * With the segment size set the file is preallocated (`posix_fallocate`) and memory mapped, so messages are copied
+     * to the mapping without any write syscall. The mapping grows by the next segment when it's full, the file is
+     * truncated to the written size when closed (until then it's padded with zeros).
+     *
+     * With asynchronous writes enabled the data is written by io_uring at explicit offsets (see AsyncFileWriter), write(2)
+     * is used if io_uring is not available.
+     */
+    class FileSink : public LogSink {
+    public:
+        /**
+         * @brief Opened file (descriptor and optional mapping).
+         */
+        struct Handle {
+            int fd = -1;
+            char* mapping = nullptr;
+            std::size_t mappedSize = 0;
+            std::uintmax_t size = 0; // Bytes written so far.
+        };
+
+        static constexpr std::size_t DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+
+    private:
+        Handle file_;
+        std::string path_;
+        std::size_t segmentSize_; // Size of the mapped segment, 0 - write(2) is used.
+        bool asyncWrites_; // Files opened from now on are written by io_uring.
+#ifdef LOGCPLUS_HAS_IO_URING
+        std::unique_ptr<AsyncFileWriter> asyncWriter_; // Used if the opened file is written asynchronously.
+        bool asyncFile_;
+#endif
+
+    public:
+        explicit FileSink(const LogLevel _level = LogLevel::Debug, std::shared_ptr<LogFormatter> _formatter = nullptr)
+            : LogSink(_level, std::move(_formatter)), segmentSize_(0), asyncWrites_(false)
+#ifdef LOGCPLUS_HAS_IO_URING
+            , asyncFile_(false)
+#endif
+        {
+
+        }
+
+        FileSink(const FileSink&) = delete;
+        FileSink& operator=(const FileSink&) = delete;
+
+        ~FileSink() override {
+            close();
+        }
+
+        /**
+         * @brief Sets the size of memory mapped segments used by the files opened from now on (0 - write(2) is used).
+         */
+        void setSegmentSize(const std::size_t _segmentSize) {
+            segmentSize_ = _segmentSize;
+        }
+
+        /**
+         * @brief Enables io_uring writes of the files opened from now on (ignored for the memory mapped files).
+         */
+        void setAsyncWrites(const bool _asyncWrites) {
+            asyncWrites_ = _asyncWrites;
+        }
+
+        /**
+         * @brief Opens (or creates) the file in append mode. Currently opened file is closed.
+         * @param _path Path to the file.
+         * @return True if file was opened.
+         */
+        bool open(const std::string& _path) {
+            close();
+
+            if (!openHandle(_path, file_)) {
+                return false;
+            }
+
+            path_ = _path;
+            return opened();
+        }
+
+        /**
+         * @brief Opens the new file and swaps it with the current one, so there is no moment without the open file. The
+         * current file stays open if the new one cannot be opened.
+         * @param _path Path to the new file.
+         * @return Handle of the previous file (releasing it is up to the caller, see `release`).
+         */
+        Handle reopen(const std::string& _path) {
+            Handle file;
+            if (!openHandle(_path, file)) {
+                return Handle();
+            }
+
+            drain();
+            path_ = _path;
+            std::swap(file, file_);
+            opened();
+
+            return file;
+        }
+
+        /**
+         * @brief Closes the file.
+         */
+        void close() {
+            drain();
+            release(file_);
+            file_ = Handle();
+        }
+
+        /**
+         * @brief Waits until all asynchronous writes are completed.
+         */
+        void drain() {
+#ifdef LOGCPLUS_HAS_IO_URING
+            if (asyncWriter_) {
+                asyncWriter_->drain();
+            }
+#endif
+        }
+
+        /**
+         * @brief Returns the number of asynchronous writes failed since the last call (they are reported after the
+         * `write` call has returned).
+         */
+        std::uint64_t takeFailedWrites() {
+#ifdef LOGCPLUS_HAS_IO_URING
+            if (asyncWriter_) {
+                return asyncWriter_->takeFailedWrites();
+            }
+#endif
+            return 0;
+        }
+
+        /**
+         * @brief Writes the file data to the disk (waits for the asynchronous writes, mapped pages are written first).
+         * Metadata is synced only when needed to read the data (fdatasync).
+         */
+        void sync() override {
+            if (file_.fd < 0) {
+                return;
+            }
+
+            drain();
+            if (file_.mapping && file_.size > 0 && ::msync(file_.mapping, static_cast<std::size_t>(file_.size), MS_SYNC) != 0) {
+                std::cerr << "logcplus: Cannot sync the log file " << path_ << ": " << std::strerror(errno) << std::endl;
+                return;
+            }
+
+            while (::fdatasync(file_.fd) != 0) {
+                if (errno != EINTR) {
+                    std::cerr << "logcplus: Cannot sync the log file " << path_ << ": " << std::strerror(errno) << std::endl;
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Writes the whole buffer. Asynchronous writes take the buffer over without copying (it's swapped with the
+         * empty one), otherwise the buffer is left untouched.
+         * @return True if all data was written (or submitted).
+         */
+        bool write(std::string& _buffer) {
+#ifdef LOGCPLUS_HAS_IO_URING
+            if (asyncFile_ && !_buffer.empty()) {
+                std::size_t size = _buffer.size();
+                if (asyncWriter_->write(file_.fd, file_.size, _buffer)) {
+                    file_.size += size;
+                    return true;
+                }
+            }
+#endif
+            return write(_buffer.data(), _buffer.size());
+        }
+
+        /**
+         * @brief Unmaps the file (truncated to the written size) and closes the descriptor.
+         */
+        static void release(const Handle& _file) {
+            if (_file.mapping) {
+                ::munmap(_file.mapping, _file.mappedSize);
+                if (::ftruncate(_file.fd, static_cast<off_t>(_file.size)) != 0) {
+                    std::cerr << "logcplus: Cannot truncate the log file: " << std::strerror(errno) << std::endl;
+                }
+            }
+
+            if (_file.fd >= 0) {
+                ::close(_file.fd);
+            }
+        }
+
+        bool isOpen() const {
+            return file_.fd >= 0;
+        }
+
+        /**
+         * @brief Truncates the trailing zero bytes of the file (preallocated part of the mapped file which wasn't truncated
+         * on close, e.g. the process was killed).
+         * @return Size of the file.
+         */
+        static std::uintmax_t truncateZeroTail(const std::string& _path) {
+            int fd = ::open(_path.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd < 0) {
+                return 0;
+            }
+
+            struct stat status{};
+            std::uintmax_t size = ::fstat(fd, &status) == 0 ? truncateZeroTail(fd, static_cast<std::uintmax_t>(status.st_size)) : 0;
+            ::close(fd);
+
+            return size;
+        }
+
+        static std::uintmax_t truncateZeroTail(const int _fd, const std::uintmax_t _size) {
+            char buffer[65536];
+            std::uintmax_t size = _size;
+            while (size > 0) {
+                std::size_t length = static_cast<std::size_t>(std::min<std::uintmax_t>(size, sizeof(buffer)));
+                if (::pread(_fd, buffer, length, static_cast<off_t>(size - length)) != static_cast<ssize_t>(length)) {
+                    break;
+                }
+
+                std::size_t data = length;
+                while (data > 0 && buffer[data - 1] == '\0') {
+                    data--;
+                }
+
+                size -= length - data;
+                if (data > 0) {
+                    break;
+                }
+            }
+
+            if (size < _size && ::ftruncate(_fd, static_cast<off_t>(size)) != 0) {
+                std::cerr << "logcplus: Cannot truncate the log file: " << std::strerror(errno) << std::endl;
+                return _size;
+            }
+
+            return size;
+        }
+
+        /**
+         * @brief Descriptor of the file opened in the append mode (-1 for the memory mapped or asynchronously written
+         * file). Used by the crash handler.
+         */
+        int appendDescriptor() const {
+#ifdef LOGCPLUS_HAS_IO_URING
+            return file_.mapping || asyncFile_ ? -1 : file_.fd;
+#else
+            return file_.mapping ? -1 : file_.fd;
+#endif
+        }
+
+        /**
+         * @brief Path to the currently (or lastly) opened file.
+         */
+        const std::string& path() const {
+            return path_;
+        }
+
+        /**
+         * @brief Size of the opened file (tracked by the sink, the file is not stat'ed).
+         */
+        std::uintmax_t size() const {
+            return file_.size;
+        }
+
+        /**
+         * @brief Writes the whole buffer (retries partial writes and interrupted calls).
+         * @return True if all data was written.
+         */
+        bool write(const char* _data, std::size_t _size) {
+            if (file_.mapping) {
+                if (!ensureMapped(file_.size + _size)) {
+                    return false;
+                }
+
+                std::memcpy(file_.mapping + file_.size, _data, _size);
+                file_.size += _size;
+                return true;
+            }
+
+#ifdef LOGCPLUS_HAS_IO_URING
+            if (asyncFile_) {
+                if (_size > 0 && asyncWriter_->write(file_.fd, file_.size, _data, _size)) {
+                    file_.size += _size;
+                    return true;
+                }
+
+                // Synchronous write at the same offset (the file is not opened in append mode).
+                drain();
+                while (_size > 0) {
+                    ssize_t written = ::pwrite(file_.fd, _data, _size, static_cast<off_t>(file_.size));
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+
+                        std::cerr << "logcplus: Cannot write to the log file " << path_ << ": " << std::strerror(errno) << std::endl;
+                        return false;
+                    }
+
+                    _data += written;
+                    _size -= static_cast<std::size_t>(written);
+                    file_.size += static_cast<std::uintmax_t>(written);
+                }
+
+                return true;
+            }
+#endif
+
+            while (_size > 0) {
+                ssize_t written = ::write(file_.fd, _data, _size);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    std::cerr << "logcplus: Cannot write to the log file " << path_ << ": " << std::strerror(errno) << std::endl;
+                    return false;
+                }
+
+                _data += written;
+                _size -= static_cast<std::size_t>(written);
+                file_.size += static_cast<std::uintmax_t>(written);
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Writes all buffers with a single gather write (retries partial writes and interrupted calls).
+         * @param _buffers Buffers to write, they are modified when the write is partial.
+         * @param _count Number of buffers.
+         * @return True if all data was written.
+         */
+        bool writev(struct iovec* _buffers, std::size_t _count) {
+#ifdef LOGCPLUS_HAS_IO_URING
+            bool copy = file_.mapping || asyncFile_;
+#else
+            bool copy = file_.mapping;
+#endif
+            if (copy) {
+                for (std::size_t i = 0; i < _count; i++) {
+                    if (!write(static_cast<const char*>(_buffers[i].iov_base), _buffers[i].iov_len)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            while (_count > 0) {
+                int count = static_cast<int>(std::min<std::size_t>(_count, IOV_MAX));
+                ssize_t written = ::writev(file_.fd, _buffers, count);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    std::cerr << "logcplus: Cannot write to the log file " << path_ << ": " << std::strerror(errno) << std::endl;
+                    return false;
+                }
+
+                // Skip fully written buffers and move the beginning of the partially written one.
+                auto remaining = static_cast<std::size_t>(written);
+                file_.size += remaining;
+                while (_count > 0 && remaining >= _buffers->iov_len) {
+                    remaining -= _buffers->iov_len;
+                    _buffers++;
+                    _count--;
+                }
+
+                if (_count > 0) {
+                    _buffers->iov_base = static_cast<char*>(_buffers->iov_base) + remaining;
+                    _buffers->iov_len -= remaining;
+                }
+            }
+
+            return true;
+        }
+
+        void write(struct iovec* _lines, std::size_t _count) override {
+            if (isOpen()) {
+                writev(_lines, _count);
+            }
+        }
+
+    protected:
+        /**
+         * @brief Called when the file was opened (`open` and `reopen`), before anything else is written to it.
+         * @return False if the file cannot be used.
+         */
+        virtual bool opened() {
+            return true;
+        }
+
+    private:
+        /**
+         * @brief Opens the file, maps the first segment if the segment size is set (falls back to write(2) on failure).
+         */
+        bool openHandle(const std::string& _path, Handle& _file) {
+            bool async = segmentSize_ == 0 && asyncWrites_ && initializeAsyncWriter();
+            int flags = segmentSize_ > 0 ? O_RDWR | O_CREAT | O_CLOEXEC : async ? O_WRONLY | O_CREAT | O_CLOEXEC : O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+            _file.fd = ::open(_path.c_str(), flags, 0644);
+            if (_file.fd < 0) {
+                std::cerr << "logcplus: Cannot open log file " << _path << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+
+            struct stat status{};
+            _file.size = ::fstat(_file.fd, &status) == 0 ? static_cast<std::uintmax_t>(status.st_size) : 0;
+
+            // Mapped file of the killed process wasn't truncated, messages are appended after the written part.
+            if (segmentSize_ > 0 && _file.size > 0) {
+                _file.size = truncateZeroTail(_file.fd, _file.size);
+            }
+
+            if (segmentSize_ > 0 && !map(_file, std::max<std::uintmax_t>(segmentSize_, _file.size))) {
+                // Drop the preallocated space.
+                if (::ftruncate(_file.fd, static_cast<off_t>(_file.size)) != 0) {
+                    std::cerr << "logcplus: Cannot truncate the log file: " << std::strerror(errno) << std::endl;
+                }
+                ::close(_file.fd);
+                _file = Handle();
+
+                std::cerr << "logcplus: Cannot map the log file " << _path << ", write(2) is used" << std::endl;
+                _file.fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+                if (_file.fd < 0) {
+                    return false;
+                }
+
+                _file.size = ::fstat(_file.fd, &status) == 0 ? static_cast<std::uintmax_t>(status.st_size) : 0;
+            }
+
+#ifdef LOGCPLUS_HAS_IO_URING
+            asyncFile_ = async;
+#endif
+            return true;
+        }
+
+        /**
+         * @brief Creates the io_uring writer on the first use.
+         * @return False if io_uring is not available (write(2) is used).
+         */
+        bool initializeAsyncWriter() {
+#ifdef LOGCPLUS_HAS_IO_URING
+            if (!asyncWriter_) {
+                asyncWriter_ = std::make_unique<AsyncFileWriter>();
+                if (!asyncWriter_->initialize()) {
+                    std::cerr << "logcplus: io_uring is not available, write(2) is used" << std::endl;
+                    asyncWriter_.reset();
+                    asyncWrites_ = false;
+                    return false;
+                }
+            }
+
+            // Failed writer is kept until the writes in flight complete, files opened from now on use write(2).
+            return !asyncWriter_->failed();
+#else
+            std::cerr << "logcplus: io_uring is not available, write(2) is used" << std::endl;
+            asyncWrites_ = false;
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Grows the mapping by the next segment(s) when the data doesn't fit.
+         */
+        bool ensureMapped(const std::uintmax_t _required) {
+            if (_required <= file_.mappedSize) {
+                return true;
+            }
+
+            if (!map(file_, std::max<std::uintmax_t>(_required, file_.mappedSize + segmentSize_))) {
+                std::cerr << "logcplus: Cannot grow the log file mapping " << path_ << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Preallocates the file and maps it (the previous mapping is replaced).
+         */
+        static bool map(Handle& _file, const std::uintmax_t _length) {
+            if (::posix_fallocate(_file.fd, 0, static_cast<off_t>(_length)) != 0) {
+                return false;
+            }
+
+            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(_length), PROT_READ | PROT_WRITE, MAP_SHARED, _file.fd, 0);
+            if (mapping == MAP_FAILED) {
+                return false;
+            }
+
+            if (_file.mapping) {
+                ::munmap(_file.mapping, _file.mappedSize);
+            }
+
+            _file.mapping = static_cast<char*>(mapping);
+            _file.mappedSize = static_cast<std::size_t>(_length);
+            return true;
+        }
+    };
+
+    /**
+     * @brief
+     * BinaryFileSink writes log messages in the binary form (see BinaryFormatter, BinaryLogDecoder and the
+     * `logcplusDecoder` tool). Open the file before the sink is added to the logger. Every opened file starts with its own
+     * string table (interned strings are defined again).
+     */
+    class BinaryFileSink : public FileSink {
+        std::shared_ptr<BinaryFormatter> binaryFormatter_;
+
+    public:
+        explicit BinaryFileSink(const LogLevel _level = LogLevel::Debug) : BinaryFileSink(_level, std::make_shared<BinaryFormatter>()) {
+
+        }
+
+    protected:
+        bool opened() override {
+            binaryFormatter_->reset();
+            return size() > 0 || FileSink::write(BinaryFormatter::MAGIC, sizeof(BinaryFormatter::MAGIC));
+        }
+
+    private:
+        BinaryFileSink(const LogLevel _level, const std::shared_ptr<BinaryFormatter>& _formatter)
+            : FileSink(_level, _formatter), binaryFormatter_(_formatter) {
+
+        }
+    };
+
+#ifdef LOGCPLUS_WITH_ZLIB
+    /**
+     * @brief
+     * GzipFileSink compresses log messages on the fly. Messages are collected into blocks and every block is written as
+     * an independent gzip member, so the file is a valid gzip stream (e.g. `zcat`) and after a crash it's readable up to
+     * the last complete block. Messages of the incomplete block are written on close.
+     */
+    class GzipFileSink : public LogSink {
+        FileSink file_;
+        z_stream stream_;
+        std::size_t blockSize_;
+        std::string block_; // Uncompressed messages of the current block.
+        std::vector<unsigned char> compressed_;
+
+    public:
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        /**
+         * @param _blockSize Size of the uncompressed block (compressed as a single gzip member).
+         * @param _compressionLevel Compression level (1 - fastest, 9 - best compression).
+         */
+        explicit GzipFileSink(const std::size_t _blockSize = DEFAULT_BLOCK_SIZE, const int _compressionLevel = Z_DEFAULT_COMPRESSION,
+                              const LogLevel _level = LogLevel::Debug, std::shared_ptr<LogFormatter> _formatter = nullptr)
+            : LogSink(_level, std::move(_formatter)), stream_(), blockSize_(std::max<std::size_t>(_blockSize, 1)) {
+            // Window bits 15 + 16 - gzip header and trailer.
+            deflateInit2(&stream_, _compressionLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+            block_.reserve(blockSize_);
+        }
+
+        GzipFileSink(const GzipFileSink&) = delete;
+        GzipFileSink& operator=(const GzipFileSink&) = delete;
+
+        ~GzipFileSink() override {
+            close();
+            deflateEnd(&stream_);
+        }
+
+        bool open(const std::string& _path) {
+            close();
+            return file_.open(_path);
+        }
+
+        /**
+         * @brief Writes the incomplete block and closes the file.
+         */
+        void close() {
+            if (file_.isOpen()) {
+                writeBlock();
+                file_.close();
+            }
+        }
+
+        bool isOpen() const {
+            return file_.isOpen();
+        }
+
+        const std::string& path() const {
+            return file_.path();
+        }
+
+        /**
+         * @brief Syncs complete blocks (the current block is not written until it's full).
+         */
+        void sync() override {
+            file_.sync();
+        }
+
+        void write(struct iovec* _lines, std::size_t _count) override {
+            if (!file_.isOpen()) {
+                return;
+            }
+
+            for (std::size_t i = 0; i < _count; i++) {
+                block_.append(static_cast<const char*>(_lines[i].iov_base), _lines[i].iov_len);
+            }
+
+            // Block is closed on the line boundary (spans contain whole lines).
+            if (block_.size() >= blockSize_) {
+                writeBlock();
+            }
+        }
+
+    private:
+        /**
+         * @brief Compresses the current block as a single gzip member.
+         */
+        void writeBlock() {
+            if (block_.empty()) {
+                return;
+            }
+
+            compressed_.resize(deflateBound(&stream_, static_cast<uLong>(block_.size())) + 32);
+            stream_.next_in = reinterpret_cast<Bytef*>(block_.data());
+            stream_.avail_in = static_cast<uInt>(block_.size());
+            stream_.next_out = compressed_.data();
+            stream_.avail_out = static_cast<uInt>(compressed_.size());
+
+            if (deflate(&stream_, Z_FINISH) == Z_STREAM_END) {
+                file_.write(reinterpret_cast<const char*>(compressed_.data()), compressed_.size() - stream_.avail_out);
+            } else {
+                std::cerr << "logcplus: Cannot compress the log block " << file_.path() << std::endl;
+            }
+
+            deflateReset(&stream_);
+            block_.clear();
+        }
+    };
+#endif
+
+    class LogManager;
+
+    /**
+     * @brief Basic c++ logger library.
+     */
+    class Logger {
+    public:
+        enum class LogMode;
+        using LogLevel = logcplus::LogLevel;
+        enum class QueueType;
+        enum class FlushPolicy;
+        enum class FormattingMode;
+        enum class OverflowPolicy;
+        enum class Compression;
+        enum class FileBackend;
+        enum class SyncPolicy;
+
+    private:
+        /**
+         * @brief Messages formatted by one formatter and waiting for the flush.
+         */
+        struct FormattedLines {
+            LogFormatter* formatter;
+            LogLevel level; // Records below the lowest level of sinks using the formatter are not formatted.
+            std::string buffer;
+            std::vector<std::pair<LogLevel, std::size_t>> lines; // Level and end of every line in the buffer.
+        };
+
+        LogMode logMode_; // Logger mode (to Console / File)
+        LogLevel logLevel_; // Log level (see log level pyramid above)
+        FormattingMode formattingMode_; // Log message formatting on the producer (eager) or queue worker (deferred) thread
+        std::atomic<TimestampCache::Precision> timestampPrecision_; // Log timestamp precision (seconds, milli- or microseconds)
+        DefaultFormatter defaultFormatter_; // Formats records for the sinks without own formatter.
+        QueueType queueType_; // Message queue implementation (locked / lock-free)
+        std::size_t queueCapacity_; // Message queue capacity (used by the bounded queues)
+        OverflowPolicy overflowPolicy_; // What to do with a new message when the bounded queue is full
+        LogLevel overflowLevel_; // Messages below this level are dropped by OverflowPolicy::DropBelowLevel
+        std::array<std::atomic<std::uint64_t>, 5> droppedMessages_; // Dropped messages per log level since the last report
+        ConsoleSink consoleSink_; // Console output (used in LogMode::Console).
+        FileSink fileSink_; // Log file (used in LogMode::File).
+        std::uintmax_t maxFileSize_; // Log file is rotated before it exceeds this size (0 - unlimited).
+        std::filesystem::path rotationPath_; // Log file moved aside by the rotation.
+        std::size_t rotationIndex_; // Next free `.N` suffix of the rotation path.
+        std::filesystem::path reopenDirectory_; // Directory of the requested reopen (see reopen).
+        std::atomic_bool reopenRequested_; // Reopen is performed by the queue worker.
+        std::condition_variable reopenedConditionVariable_;
+        Compression compression_; // Compression of the rotated log files.
+        FileBackend fileBackend_; // How the log file is written (applied when the file is opened).
+        TaskWorker backgroundTasks_; // Closes rotated files off the queue worker thread.
+        TaskWorker compressionTasks_; // Compresses rotated files (low priority thread).
+        std::vector<std::shared_ptr<LogSink>> sinks_; // Additional sinks (see addSink).
+        std::vector<std::size_t> sinkFormatters_; // Index of the formatted lines used by every additional sink.
+        std::mutex sinksMutex_; // Guards sinks and formatted lines.
+        RecordPool recordPool_; // Preallocated log records (see LOGCPLUS_RECORD_POOL_SIZE).
+        std::unique_ptr<MessageQueue<LogRecord*>> messageQueue_;
+        std::thread messageQueueWorker_;
+        WaitStrategy waitStrategy_; // Wakes up the queue worker when a new message is available.
+        std::atomic_bool work_;
+        std::vector<FormattedLines> formattedLines_; // Coalesced messages waiting for the flush (one entry per formatter).
+        std::vector<struct iovec> writeSpans_; // Spans of the formatted lines passed to the sink.
+        FlushPolicy flushPolicy_; // When the write buffer is flushed to the output.
+        std::chrono::milliseconds flushInterval_; // Used by FlushPolicy::Interval.
+        std::size_t flushBytes_; // Used by FlushPolicy::Bytes.
+        std::chrono::steady_clock::time_point lastFlush_;
+        SyncPolicy syncPolicy_; // When the written messages are synced to the disk (guarded by the sinks mutex).
+        std::chrono::milliseconds syncInterval_; // Used by SyncPolicy::Periodic.
+        std::chrono::steady_clock::time_point lastSync_;
+        bool unsynced_; // Messages were written since the last sync.
+        std::atomic_int crashSignal_; // Fatal signal caught by the crash handler (0 - none).
+        std::atomic_bool crashFlushed_; // Pending messages were written by the queue worker after the crash.
+        std::atomic_long workerThreadId_; // Kernel id of the queue worker thread (0 - not running).
+        std::atomic_int crashDescriptor_; // Written by the crash handler if the queue worker doesn't respond.
+        long crashUtcOffset_; // Local time offset (seconds) used by the crash handler.
+        bool crashHandlerInstalled_;
+        std::atomic_int crashWakeDescriptor_; // Eventfd written by the crash handler to wake the queue worker.
+        std::thread crashWaker_; // Wakes the queue worker when the crash handler writes the eventfd.
+        std::atomic<SharedMemoryRing*> sharedRing_; // Copies of the queued records (see setSharedMemoryRing).
+        std::vector<std::unique_ptr<SharedMemoryRing>> sharedRings_; // Replaced rings stay mapped (racing producers).
+        std::vector<std::uint64_t> ringOffsets_; // Ring entries of the formatted records, consumed after the flush.
+        std::atomic<std::size_t> backtraceSize_; // Number of recent messages below the log level kept (0 - disabled).
+        std::vector<LogRecord*> backtrace_; // Backtrace buffer (circular, queue worker only).
+        std::size_t backtraceStart_; // Oldest record in the backtrace buffer.
+        std::size_t backtraceCount_;
+        std::vector<LogRecord*> backtraceBatch_; // Batch with the dumped backtrace records.
+        std::atomic<bool> latencyStatistics_; // Records are stamped with the enqueue time and latency is measured.
+        std::chrono::milliseconds latencyReportInterval_; // Interval of the latency log message, 0 - not reported.
+        std::chrono::steady_clock::time_point lastLatencyReport_;
+        LatencyHistogram queueWaitHistogram_;
+        LatencyHistogram formatHistogram_;
+        LatencyHistogram writeHistogram_;
+        LatencyHistogram endToEndHistogram_;
+        std::array<LatencyHistogram::Snapshot, 4> latencyReported_; // Histograms at the last latency report.
+        std::vector<std::chrono::steady_clock::time_point> pendingEnqueueTimes_; // Formatted records waiting for the flush.
+
+        // Statistics counters (see statistics), per level counters take 5 consecutive slots.
+        static constexpr std::size_t ENQUEUED_COUNTER = 0;
+        static constexpr std::size_t DROPPED_COUNTER = 5;
+        static constexpr std::size_t WRITTEN_COUNTER = 10;
+        static constexpr std::size_t BYTES_WRITTEN_COUNTER = 15;
+        static constexpr std::size_t ROTATIONS_COUNTER = 16;
+        static constexpr std::size_t WRITE_ERRORS_COUNTER = 17;
+        static constexpr std::size_t COUNTERS = 18;
+        ShardedCounters<COUNTERS> counters_;
+
+        // Max number of messages drained from the queue at once.
+        static constexpr std::size_t MAX_BATCH_SIZE = 4096;
+        // Index of the formatted lines written to the main sink (console or log file).
+        static constexpr std::size_t MAIN_SINK_LINES = 0;
+        // Capacity of the lock-free queues if not specified.
+        static constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 65536;
+
+        inline static std::atomic<Logger*> instance_{nullptr};
+        inline static std::mutex instanceMutex_;
+        // Signals handled by the crash handler and their previous actions.
+        inline static constexpr std::array<int, 4> CRASH_SIGNALS = {SIGSEGV, SIGABRT, SIGBUS, SIGFPE};
+        inline static std::array<struct sigaction, 4> previousCrashActions_{};
+        // Alternate signal stack of the thread which installed the crash handler and its previous alternate stack.
+        static constexpr std::size_t CRASH_STACK_SIZE = 64 * 1024;
+        inline static std::unique_ptr<char[]> crashStack_;
+        inline static stack_t previousCrashStack_{};
+
+        friend class LogManager;
+
+    public:
+        enum class LogMode {
+            Console, File
+        };
+
+        /*
+         * Eager - log message is formatted on the caller thread
+         * Deferred - caller only packs raw arguments, timestamp and message are formatted by the queue worker
+         */
+        enum class FormattingMode {
+            Eager, Deferred
+        };
+
+        /*
+         * Locked - unbounded queue guarded by the mutex (see ConcurrentQueue)
+         * LockFree - bounded lock-free ring buffer (see RingBuffer)
+         * PerThread - bounded lock-free buffer per producer thread merged by timestamp (see PerThreadQueue)
+         */
+        enum class QueueType {
+            Locked, LockFree, PerThread
+        };
+
+        /*
+         * Block - producer waits for a free space in the queue
+         * DropNewest - new message is dropped
+         * DropOldest - the oldest pending message is dropped (DropNewest for the PerThread queue)
+         * DropBelowLevel - new message below overflow level is dropped, otherwise producer waits (e.g. keep Error/Fatal)
+         */
+        enum class OverflowPolicy {
+            Block, DropNewest, DropOldest, DropBelowLevel
+        };
+
+        /*
+         * Write - messages are written with write(2)
+         * Mmap - log file is preallocated and memory mapped in segments of the max log file size (no write syscalls)
+         * IoUring - messages are written asynchronously by io_uring with several buffers in flight (falls back to Write)
+         */
+        enum class FileBackend {
+            Write, Mmap, IoUring
+        };
+
+        /*
+         * None - rotated log files are left uncompressed
+         * Gzip - rotated log files are compressed to `.gz` on the background thread (requires LOGCPLUS_WITH_ZLIB)
+         */
+        enum class Compression {
+            None, Gzip
+        };
+
+        /*
+         * EveryBatch - flush after every drained batch of messages
+         * Interval - flush when the flush interval elapsed
+         * Bytes - flush when the write buffer exceeds the flush size
+         */
+        enum class FlushPolicy {
+            EveryBatch, Interval, Bytes
+        };
+
+        /*
+         * None - messages are never synced explicitly (the page cache is written by the kernel)
+         * Periodic - written messages are synced when the sync interval elapsed
+         * OnError - written messages are synced after the flush containing Error or Fatal message
+         * EveryBatch - written messages are synced after every flush
+         *
+         * Every sync is a group commit: a single fdatasync covers all messages written since the previous one.
+         */
+        enum class SyncPolicy {
+            None, Periodic, OnError, EveryBatch
+        };
+
+        /*
+         * Latency of the records written since the statistics were enabled (see setLatencyStatistics):
+         * queueWait - from the log call to the moment the queue worker took the record from the queue
+         * format - formatting of a single record by a single formatter
+         * write - writing of the flushed buffers to all sinks (once per flush)
+         * endToEnd - from the log call to the end of the flush which wrote the record
+         */
+        struct LatencyStatistics {
+            LatencyHistogram::Summary queueWait;
+            LatencyHistogram::Summary format;
+            LatencyHistogram::Summary write;
+            LatencyHistogram::Summary endToEnd;
+        };
+
+        /*
+         * Logging pipeline counters since the start of the process (per level counters are indexed by LogLevel):
+         * enqueued - records accepted by the message queue (including the backtrace records)
+         * dropped - records dropped by the overflow policy
+         * written - lines written to the main sink (console or log file), including the logger own messages
+         * bytesWritten - bytes written to the main sink
+         * queueDepth - current number of records in the message queue
+         * rotations - rotated log files
+         * removedFiles - log files removed by the auto remove (see LogManager::statistics)
+         * writeErrors - failed writes to the log file
+         */
+        struct Statistics {
+            std::array<std::uint64_t, 5> enqueued{};
+            std::array<std::uint64_t, 5> dropped{};
+            std::array<std::uint64_t, 5> written{};
+            std::uint64_t bytesWritten = 0;
+            std::uint64_t queueDepth = 0;
+            std::uint64_t rotations = 0;
+            std::uint64_t removedFiles = 0;
+            std::uint64_t writeErrors = 0;
+        };
+
+        /**
+         * @brief Checks if the log level was not stripped at compile time (see LOGCPLUS_ACTIVE_LEVEL).
+         * @param _logLevel Message log level.
+         */
+        static constexpr bool isActive(const LogLevel _logLevel) {
+            return static_cast<int>(_logLevel) >= LOGCPLUS_ACTIVE_LEVEL;
+        }
+
+        /**
+         * @brief Checks if the message with given log level will be printed by the logger.
+         * @param _logLevel Message log level.
+         */
+        bool isEnabled(const LogLevel _logLevel) const {
+            return isActive(_logLevel) && logLevel_ <= _logLevel;
+        }
+
+        /**
+         * @brief Checks if the message below the log level will be kept in the backtrace buffer.
+         * @param _logLevel Message log level.
+         */
+        bool isBacktraced(const LogLevel _logLevel) const {
+            return isActive(_logLevel) && backtraceSize_.load(std::memory_order_relaxed) > 0;
+        }
+
+        /**
+         * @brief Keeps the message in the backtrace buffer (the last `setBacktraceSize` messages below the log level).
+         * Arguments are only packed, the message is formatted when the buffer is written: before the next Error or
+         * Fatal message or on `dumpBacktrace` request.
+         */
+        template<typename ...Args>
+        void backtrace(Logger::LogLevel _logLevel, const Args& ..._args) {
+            LogRecord* record = recordPool_.acquire();
+            record->level = _logLevel;
+            record->timestamp = std::chrono::system_clock::now();
+            record->kind = LogRecord::Kind::Backtrace;
+            record->deferred = true;
+            LogArguments::pack(*record, _args...);
+
+            enqueue(record);
+        }
+
+        /**
+         * @brief Writes the messages from the backtrace buffer (after all messages logged before this call).
+         */
+        void dumpBacktrace() {
+            LogRecord* record = recordPool_.acquire();
+            record->timestamp = std::chrono::system_clock::now();
+            record->kind = LogRecord::Kind::DumpBacktrace;
+
+            enqueue(record);
+        }
+
+        /**
+         * @brief Sets the number of recent messages below the log level kept in the backtrace buffer.
+         * @param _backtraceSize Number of messages, 0 - disabled.
+         */
+        void setBacktraceSize(const std::size_t _backtraceSize) {
+            backtraceSize_.store(_backtraceSize, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Enables latency measurement: records are stamped with the monotonic enqueue time and the queue worker
+         * counts the queue wait, format, write and end to end latency in histograms (see latencyStatistics).
+         * @param _enabled Latency is measured.
+         * @param _reportInterval Interval of the latency log message (percentiles since the previous report), 0 - not
+         * reported.
+         */
+        void setLatencyStatistics(const bool _enabled, const std::chrono::milliseconds _reportInterval) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            latencyReportInterval_ = _reportInterval;
+            lastLatencyReport_ = std::chrono::steady_clock::now();
+            latencyStatistics_.store(_enabled, std::memory_order_release);
+        }
+
+        /**
+         * @brief Latency of the records written since the start (can be called from any thread).
+         */
+        LatencyStatistics latencyStatistics() const {
+            return {queueWaitHistogram_.summary(), formatHistogram_.summary(), writeHistogram_.summary(), endToEndHistogram_.summary()};
+        }
+
+        /**
+         * @brief Logging pipeline counters (can be called from any thread, the hot path is never blocked).
+         */
+        Statistics statistics() const {
+            Statistics statistics;
+            for (std::size_t level = 0; level < statistics.enqueued.size(); level++) {
+                statistics.enqueued[level] = counters_.load(ENQUEUED_COUNTER + level);
+                statistics.dropped[level] = counters_.load(DROPPED_COUNTER + level);
+                statistics.written[level] = counters_.load(WRITTEN_COUNTER + level);
             }
 
-            execute_.store(true, std::memory_order_release);
-            timerThread_ = std::thread([=]() {
-                while (execute_.load(std::memory_order_acquire)) {
-                    if (_callback) {
-                        _callback();
-                    }
+            statistics.bytesWritten = counters_.load(BYTES_WRITTEN_COUNTER);
+            statistics.queueDepth = messageQueue_->length();
+            statistics.rotations = counters_.load(ROTATIONS_COUNTER);
+            statistics.writeErrors = counters_.load(WRITE_ERRORS_COUNTER);
 
-                    std::this_thread::sleep_for(_interval);
+            return statistics;
+        }
+
+        /**
+         * @brief Current opened file handler.
+         * @return Current filename.
+         */
+        std::string currentFile() const {
+            return fileSink_.path();
+        }
+
+        /**
+         * @brief Helper method with defined log level. See `log` method for details.
+         */
+        template<typename ...Args>
+        void debug(const Args& ..._args) {
+            if constexpr (isActive(LogLevel::Debug)) {
+                if (logLevel_ <= Logger::LogLevel::Debug) {
+                    log(LogLevel::Debug, _args...);
+                } else if (backtraceSize_.load(std::memory_order_relaxed) > 0) {
+                    backtrace(LogLevel::Debug, _args...);
                 }
-            });
+            }
         }
 
         /**
-         * @brief Run callback method specific timeout.
-         * @param _interval The callback interval.
-         * @param _callback The callback method.
+         * @brief Helper method with defined log level. See `log` method for details.
          */
-        template<typename Rep, typename Period>
-        void setTimeout(const std::chrono::duration<Rep, Period>& _interval, std::function<void()> _callback) {
-            timerThread_ = std::thread([=]() {
-                std::this_thread::sleep_for(_interval);
+        template<typename ...Args>
+        void info(const Args& ..._args) {
+            if constexpr (isActive(LogLevel::Info)) {
+                if (logLevel_ <= Logger::LogLevel::Info) {
+                    log(LogLevel::Info, _args...);
+                } else if (backtraceSize_.load(std::memory_order_relaxed) > 0) {
+                    backtrace(LogLevel::Info, _args...);
+                }
+            }
+        }
 
-                if (_callback) {
-                    _callback();
+        /**
+         * @brief Helper method with defined log level. See `log` method for details.
+         */
+        template<typename ...Args>
+        void warn(const Args& ..._args) {
+            if constexpr (isActive(LogLevel::Warn)) {
+                if (logLevel_ <= Logger::LogLevel::Warn) {
+                    log(LogLevel::Warn, _args...);
+                } else if (backtraceSize_.load(std::memory_order_relaxed) > 0) {
+                    backtrace(LogLevel::Warn, _args...);
                 }
-            });
+            }
         }
 
         /**
-         * @brief Stops timer.
+         * @brief Helper method with defined log level. See `log` method for details.
          */
-        void stop() {
-            stopPoint_ = Clock::now();
+        template<typename ...Args>
+        void error(const Args& ..._args) {
+            if constexpr (isActive(LogLevel::Error)) {
+                if (logLevel_ <= Logger::LogLevel::Error) {
+                    log(LogLevel::Error, _args...);
+                } else if (backtraceSize_.load(std::memory_order_relaxed) > 0) {
+                    backtrace(LogLevel::Error, _args...);
+                }
+            }
+        }
 
-            // Wait for thread execution.
-            execute_.store(false, std::memory_order_release);
-            if (timerThread_.joinable()) {
-                timerThread_.join();
+        /**
+         * @brief Helper method with defined log level. See `log` method for details.
+         */
+        template<typename ...Args>
+        void fatal(const Args& ..._args) {
+            if constexpr (isActive(LogLevel::Fatal)) {
+                if (logLevel_ <= Logger::LogLevel::Fatal) {
+                    log(LogLevel::Fatal, _args...);
+                } else if (backtraceSize_.load(std::memory_order_relaxed) > 0) {
+                    backtrace(LogLevel::Fatal, _args...);
+                }
             }
         }
 
         /**
-         * @brief Returns current elapsed time (between start and stop snapshot).
-         * @return The timer elapsed time.
+         * @brief Print log with timestamp.
+         * @param _args Log message parameters
          */
-        template<typename Rep = typename Clock::duration::rep, typename Units = typename Clock::duration>
-        Rep elapsedTime() {
-            std::atomic_thread_fence(std::memory_order_relaxed);
-            auto countedTime = std::chrono::duration_cast<Units>(startPoint_ - stopPoint_).count();
-            std::atomic_thread_fence(std::memory_order_relaxed);
+        template<typename ...Args>
+        void log(Logger::LogLevel _logLevel, const Args& ..._args) {
+            // The record is filled in place (no temporary strings).
+            LogRecord* record = recordPool_.acquire();
+            record->level = _logLevel;
+            record->timestamp = std::chrono::system_clock::now();
+
+            if (formattingMode_ == FormattingMode::Deferred) {
+                record->deferred = true;
+                LogArguments::pack(*record, _args...);
+            } else {
+                record->push_back('[');
+                record->append(logTypeAsString(_logLevel));
+                record->append("] ", 2);
+                record->append(formatTimestamp(record->timestamp));
+                record->append(" -", 2);
+                record->messageOffset = static_cast<std::uint32_t>(record->payload().size());
+                LogArguments::concatenate(*record, _args...);
+            }
 
-            return static_cast<Rep>(countedTime);
+            if (SharedMemoryRing* ring = sharedRing_.load(std::memory_order_acquire)) {
+                record->ringOffset = ring->write(*record);
+            }
+
+            if (latencyStatistics_.load(std::memory_order_relaxed)) {
+                record->enqueueTime = std::chrono::steady_clock::now();
+            }
+
+            enqueue(record);
         }
-    };
 
-    // Predefined timers types.
-    using PreciseTimer = Timer<>;
-    using SystemTimer = Timer<std::chrono::system_clock>;
-    using SteadyTimer = Timer<std::chrono::steady_clock>;
+        /**
+         * @brief Adds file separator if not exits.
+         * @param _file Current full filename path
+         * @return Filename path with separator (optional if exists or is empty)
+         */
+        std::optional<std::string> addOptionalFileSeparator(const std::string& _file) {
+            if (!isFileExist(_file)) {
+                return std::nullopt;
+            }
 
-    /**
-     * @brief File size representation.
-     */
-    typedef struct FileSize {
-        enum class SizeUnit {
-            B = 1, KB = 1000, KiB = 1024, MB = 1000000, MiB = 1048576, GB = 1000000000, GiB = 1073741824
-        };
+            if (_file.size() > 0) {
+                if (_file[_file.length() - 1] != '/') {
+                    return std::string(_file + "/");
+                }
+            }
 
-        FileSize() : size(1), unit(SizeUnit::B) {}
+            return std::nullopt;
+        }
 
-        FileSize(const std::uintmax_t _size, const SizeUnit _unit) {
-            this->size = _size;
-            this->unit = _unit;
+        /**
+         * @brief Checks if given file exists.
+         * @param _path Full path to file (filename)
+         * @return If file exists => true
+         */
+        static bool isFileExist(const std::filesystem::path& _path, std::filesystem::file_status _status = std::filesystem::file_status()) {
+            if (std::filesystem::status_known(_status) ? std::filesystem::exists(_status) : std::filesystem::exists(_path)) {
+                return true;
+            }
+
+            return false;
         }
 
-        friend bool operator==(const FileSize& _lhs, const FileSize& _rhs) {
-            return (_lhs.size == _rhs.size && _lhs.unit == _rhs.unit);
+        /**
+         * @brief Checks if exists any files in given path.
+         * @param _directory Full path to directory to check
+         * @param _fileSought File sought
+         * @return Number of files found
+         */
+        static int anyFileExists(const std::string& _directory, const std::string& _fileSought) {
+            int count = 0;
+
+            for (const auto& path: std::filesystem::directory_iterator(_directory)) {
+                std::string filename = path.path().filename();
+
+                if (filename.find(_fileSought) != std::string::npos) {
+                    count++;
+                }
+            }
+
+            return count;
         }
 
-        friend bool operator!=(const FileSize& _lhs, const FileSize& _rhs) {
-            return !(_lhs == _rhs);
+    private:
+        Logger() : logMode_(Logger::LogMode::Console), logLevel_(Logger::LogLevel::Debug), formattingMode_(Logger::FormattingMode::Eager),
+                   timestampPrecision_(TimestampCache::Precision::Seconds),
+                   queueType_(Logger::QueueType::Locked), queueCapacity_(0), overflowPolicy_(Logger::OverflowPolicy::Block),
+                   overflowLevel_(Logger::LogLevel::Error), droppedMessages_(), maxFileSize_(0), rotationIndex_(1), reopenRequested_(false),
+                   compression_(Logger::Compression::None), fileBackend_(Logger::FileBackend::Write), compressionTasks_(true), recordPool_(LOGCPLUS_RECORD_POOL_SIZE, LOGCPLUS_SLAB_CHUNKS),
+                   messageQueue_(std::make_unique<ConcurrentQueue<LogRecord*>>()), work_(false),
+                   flushPolicy_(Logger::FlushPolicy::EveryBatch), flushInterval_(100), flushBytes_(65536),
+                   syncPolicy_(Logger::SyncPolicy::None), syncInterval_(1000), unsynced_(false), crashSignal_(0), crashFlushed_(false),
+                   workerThreadId_(0), crashDescriptor_(STDOUT_FILENO), crashUtcOffset_(0), crashHandlerInstalled_(false), crashWakeDescriptor_(-1), sharedRing_(nullptr),
+                   backtraceSize_(0), backtraceStart_(0), backtraceCount_(0), latencyStatistics_(false), latencyReportInterval_(0) {
+            formattedLines_.push_back({&defaultFormatter_, LogLevel::Debug, {}, {}});
         }
 
-        friend bool operator<(const FileSize& _lhs, const FileSize& _rhs) {
-            return (_lhs.bsize() < _rhs.bsize());
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        ~Logger() {
+            setCrashHandler(false);
+            stop();
         }
 
-        friend bool operator>(const FileSize& _lhs, const FileSize& _rhs) {
-            return (_lhs < _rhs);
+        /**
+         * @brief Gets current singleton instance. We allows only for one instance of logger.
+         * @return Logger instance
+         */
+        static Logger* instance() {
+            if (instance_ == nullptr) {
+                std::lock_guard<std::mutex> lock(instanceMutex_);
+                if (instance_ == nullptr) {
+                    instance_ = new Logger();
+                }
+            }
+
+            return instance_;
+        }
+
+        /**
+         * @brief Runs queue worker.
+         * @return Successfully initialized.
+         */
+        void initialize() {
+            processQueue();
         }
 
-        friend bool operator<=(const FileSize& _lhs, const FileSize& _rhs) {
-            return !(_lhs > _rhs);
-        }
+        /**
+         * @brief Replaces the message queue implementation. Pending messages are moved to the new queue.
+         *
+         * Producers use the queue without any synchronization with the swap, so the queue can be replaced only before
+         * the queue worker is started (or after `stop`) when nothing is logged.
+         *
+         * @param _queueType Queue implementation.
+         * @param _queueCapacity Queue capacity, 0 - unbounded locked queue or default capacity of the lock-free queues.
+         * @return False if the queue worker is running (the queue is not replaced).
+         */
+        bool setQueueType(const QueueType _queueType, const std::size_t _queueCapacity) {
+            if (_queueType == queueType_ && _queueCapacity == queueCapacity_) {
+                return true;
+            }
+
+            if (work_.load(std::memory_order_acquire)) {
+                std::cerr << "logcplus: Queue type cannot be changed while the logger is running (shutdown the logger first)" << std::endl;
+                return false;
+            }
+
+            std::size_t boundedCapacity = _queueCapacity > 0 ? _queueCapacity : DEFAULT_QUEUE_CAPACITY;
+            std::unique_ptr<MessageQueue<LogRecord*>> queue;
+            if (_queueType == QueueType::LockFree) {
+                queue = std::make_unique<RingBuffer<LogRecord*>>(boundedCapacity);
+            } else if (_queueType == QueueType::PerThread) {
+                queue = std::make_unique<PerThreadQueue<LogRecord*, LogRecord::TimestampLess>>(boundedCapacity);
+            } else {
+                queue = std::make_unique<ConcurrentQueue<LogRecord*>>(_queueCapacity);
+            }
+
+            LogRecord* record;
+            while (messageQueue_->tryDequeue(record)) {
+                if (!queue->tryEnqueue(std::move(record))) {
+                    dropMessage(record);
+                }
+            }
+
+            messageQueue_ = std::move(queue);
+            queueType_ = _queueType;
+            queueCapacity_ = _queueCapacity;
 
-        friend bool operator>=(const FileSize& _lhs, const FileSize& _rhs) {
-            return !(_lhs < _rhs);
+            return true;
         }
 
         /**
-         * @brief Returns size in bytes.
+         * @brief Enables the copy of queued records in the shared memory ring (see SharedMemoryRing), the ring file is
+         * removed when disabled or when the logger is stopped.
+         *
+         * The queue worker is stopped for the swap (pending messages are written), so it should be called before any
+         * producer starts logging.
+         *
+         * @param _enabled Shared memory ring is used.
+         * @param _capacity Ring capacity in bytes.
          */
-        std::uintmax_t bsize() const {
-            return this->size * static_cast<std::uintmax_t>(this->unit);
-        }
+        void setSharedMemoryRing(const bool _enabled, const std::size_t _capacity) {
+            SharedMemoryRing* current = sharedRing_.load(std::memory_order_acquire);
+            if (_enabled == (current != nullptr) && (!current || current->capacity() >= _capacity)) {
+                return;
+            }
 
-        /**
-         * @brief See static `toString` implementation.
-         */
-        std::string toString() const {
-            return FileSize::toString(this->size, this->unit);
-        }
+            bool working = work_.load(std::memory_order_acquire);
+            work_.store(false, std::memory_order_release);
+            waitStrategy_.notifyAll();
+            if (messageQueueWorker_.joinable()) {
+                messageQueueWorker_.join();
+            }
 
-        /**
-         * @brief Returns FileSize as text.
-         * @param _size File size.
-         * @param _unit File size unit.
-         * @return FileSize as text, e.g. 50MiB
-         */
-        static std::string toString(std::intmax_t _size, SizeUnit _unit) {
-            std::string unit;
-            switch (_unit) {
-                case SizeUnit::KB:
-                    unit = "KB";
-                    break;
-                case SizeUnit::KiB:
-                    unit = "KiB";
-                    break;
-                case SizeUnit::MB:
-                    unit = "MB";
-                    break;
-                case SizeUnit::MiB:
-                    unit = "MiB";
-                    break;
-                case SizeUnit::GB:
-                    unit = "GB";
-                    break;
-                case SizeUnit::GiB:
-                    unit = "GiB";
-                    break;
-                case SizeUnit::B:
-                default:
-                    unit = "B";
-                    break;
+            if (current) {
+                current->unlink();
             }
 
-            return std::to_string(_size).append(unit);
+            SharedMemoryRing* ring = nullptr;
+            if (_enabled) {
+                if (auto created = SharedMemoryRing::create(SharedMemoryRing::defaultPath(), _capacity)) {
+                    ring = created.get();
+                    sharedRings_.push_back(std::move(created));
+                }
+            }
+            sharedRing_.store(ring, std::memory_order_release);
+
+            if (working) {
+                processQueue();
+            }
         }
 
         /**
-         * @brief Converts text file size format to class format convention.
-         * @param _fileSize File size format as text.
-         *
-         * Expected format: NU,
-         * where
-         *  - N is std::intmax_t
-         *  - U is SizeUnit as text
-         *
-         * Example: 50MB, 100KiB
+         * @brief Inserts the record into the message queue. Applies overflow policy when the bounded queue is full.
+         * @param _record Log record.
          */
-        static std::optional<FileSize> parseFileSize(const std::string& _fileSize) {
-            FileSize result;
-
-            try {
-                // First: check if text has file size as digit.
-                std::size_t it = 0;
-                for (it = 0; it < _fileSize.size(); it++) {
-                    if (!std::isdigit(_fileSize.at(it))) {
-                        break;
-                    }
+        void enqueue(LogRecord* _record) {
+            // The record can be written (and released) as soon as it's in the queue.
+            std::size_t counter = ENQUEUED_COUNTER + static_cast<std::size_t>(_record->level);
+            bool counted = _record->kind == LogRecord::Kind::Message;
+
+            if (messageQueue_->tryEnqueue(std::move(_record))) {
+                if (counted) {
+                    counters_.add(counter);
                 }
+                waitStrategy_.notify();
+                return;
+            }
 
-                // Second: check if text has file size unit.
-                if (it > 0 && it < _fileSize.size()) {
-                    int size = std::stoi(_fileSize.substr(0, it));
-                    if (size <= 0) {
-                        return std::nullopt;
+            // Queue is full - the worker is definitely not parked, but wake it up anyway before we wait.
+            waitStrategy_.notify();
+
+            // Backtrace dump request is not a message, it's never dropped.
+            if (_record->kind == LogRecord::Kind::DumpBacktrace) {
+                messageQueue_->enqueue(_record);
+                waitStrategy_.notify();
+                return;
+            }
+
+            switch (overflowPolicy_) {
+                case OverflowPolicy::DropNewest:
+                    dropMessage(_record);
+                    return;
+                case OverflowPolicy::DropOldest:
+                    if (messageQueue_->isMultiConsumer()) {
+                        LogRecord* oldest;
+                        for (int attempt = 0; attempt < 16; attempt++) {
+                            if (messageQueue_->tryDequeue(oldest)) {
+                                dropMessage(oldest);
+                            }
+
+                            if (messageQueue_->tryEnqueue(std::move(_record))) {
+                                if (counted) {
+                                    counters_.add(counter);
+                                }
+                                waitStrategy_.notify();
+                                return;
+                            }
+                        }
                     }
 
-                    result.size = size;
-                    std::string unit = _fileSize.substr(it);
+                    dropMessage(_record);
+                    return;
+                case OverflowPolicy::DropBelowLevel:
+                    if (_record->level < overflowLevel_) {
+                        dropMessage(_record);
+                        return;
+                    }
 
-                    if (unit == "B") {
-                        result.unit = SizeUnit::B;
-                    } else if (unit == "KB") {
-                        result.unit = SizeUnit::KB;
-                    } else if (unit == "KiB") {
-                        result.unit = SizeUnit::KiB;
-                    } else if (unit == "MB") {
-                        result.unit = SizeUnit::MB;
-                    } else if (unit == "MiB") {
-                        result.unit = SizeUnit::MiB;
-                    } else if (unit == "GB") {
-                        result.unit = SizeUnit::GB;
-                    } else if (unit == "GiB") {
-                        result.unit = SizeUnit::GiB;
-                    } else {
-                        return std::nullopt;
+                    messageQueue_->enqueue(_record);
+                    if (counted) {
+                        counters_.add(counter);
                     }
-                }
+                    waitStrategy_.notify();
+                    return;
+                case OverflowPolicy::Block:
+                default:
+                    messageQueue_->enqueue(_record);
+                    if (counted) {
+                        counters_.add(counter);
+                    }
+                    waitStrategy_.notify();
+                    return;
+            }
+        }
 
-                return result;
-            } catch (const std::exception& _ex) {
-                std::cerr << "logcplus: Cannot parse file size, reason: " << _ex.what() << std::endl;
-                return std::nullopt;
+        /**
+         * @brief Counts dropped message (the counters are reported by the queue worker as a log message) and returns
+         * the record to the pool. Dropped backtrace records are not counted (they are not written anyway).
+         * @param _record Dropped message.
+         */
+        void dropMessage(LogRecord* _record) {
+            if (_record->kind == LogRecord::Kind::Message) {
+                droppedMessages_[static_cast<std::size_t>(_record->level)].fetch_add(1, std::memory_order_relaxed);
+                counters_.add(DROPPED_COUNTER + static_cast<std::size_t>(_record->level));
             }
+            if (SharedMemoryRing* ring = sharedRing_.load(std::memory_order_acquire)) {
+                ring->consume(_record->ringOffset);
+            }
+            recordPool_.release(_record);
         }
 
-        std::uintmax_t size;
-        SizeUnit unit;
-    } filesize_t;
+        /**
+         * @brief Creates a log message with the number of dropped messages since the last report (if any).
+         * @param _records Output batch, the report is appended at the end.
+         */
+        void reportDroppedMessages(std::vector<LogRecord*>& _records) {
+            std::uint64_t dropped[5];
+            std::uint64_t total = 0;
+            for (std::size_t level = 0; level < droppedMessages_.size(); level++) {
+                dropped[level] = droppedMessages_[level].exchange(0, std::memory_order_relaxed);
+                total += dropped[level];
+            }
 
-    /**
-     * @brief
-     * The DirectoryWatcher class is a basic directory watcher (extension for the logger class). We can define max
-     * file "alive" time and filename pattern. Removes all files (or matching pattern) in specified directory path.
-     */
-    class DirectoryWatcher {
-        PreciseTimer timer_;
-        const char* filePattern_; // Optional filename pattern.
-        unsigned long long fileExpiration_; // File modification time expiration (milliseconds). After this value we should remove pattern files.
-        std::string logDirectory_; // Directory to watch.
+            if (total == 0) {
+                return;
+            }
 
-    public:
-        ~DirectoryWatcher() {
-            // Stop timer if was not stopped yet.
-            stop();
+            LogRecord* record = recordPool_.acquire();
+            record->level = LogLevel::Warn;
+            record->timestamp = std::chrono::system_clock::now();
+            record->deferred = true;
+            LogArguments::pack(*record, "logcplus: message queue is full, dropped", total, "messages (DEBUG:", dropped[0], "INFO:",
+                               dropped[1], "WARN:", dropped[2], "ERROR:", dropped[3], "FATAL:", dropped[4], ")");
+            _records.push_back(record);
         }
 
         /**
-         * @brief Starts directory watcher.
-         * @param _logDirectory The log directory.
-         * @param _fileExpirationMillis The files expiration time (we checking for last modification time) in milliseconds.
-         * @param _filePattern The file pattern (optional, can be empty). We can choose which files in the directory will be removed.
-         * @param _timerInterval The Watcher check interval, default: every 1 hour.
+         * @brief Creates a log message with the latency percentiles since the last report when the report interval
+         * elapsed (see setLatencyStatistics).
+         * @param _records Output batch, the report is appended at the end.
          */
-        void start(const std::string& _logDirectory, const unsigned long long _fileExpirationMills, const char* _filePattern = "",
-                   const unsigned long long _timerInterval = Timer<>::Milliseconds.HOUR) {
-            if (!timer_.isRunning()) {
-                logDirectory_ = _logDirectory;
-                fileExpiration_ = _fileExpirationMills;
-                filePattern_ = _filePattern;
-
-                // First call without any delay.
-                removeOldLogFiles();
+        void reportLatency(std::vector<LogRecord*>& _records) {
+            if (!latencyStatistics_.load(std::memory_order_acquire)) {
+                return;
+            }
 
-                if (!timer_.isRunning()) {
-                    timer_.startInterval(std::chrono::milliseconds(_timerInterval), [=] {
-                        removeOldLogFiles();
-                    });
+            {
+                std::lock_guard<std::mutex> lock(sinksMutex_);
+                auto now = std::chrono::steady_clock::now();
+                if (latencyReportInterval_.count() == 0 || now - lastLatencyReport_ < latencyReportInterval_) {
+                    return;
                 }
+                lastLatencyReport_ = now;
+            }
+
+            std::array<LatencyHistogram::Snapshot, 4> current{queueWaitHistogram_.snapshot(), formatHistogram_.snapshot(),
+                                                              writeHistogram_.snapshot(), endToEndHistogram_.snapshot()};
+            LatencyHistogram::Summary summaries[4];
+            for (std::size_t i = 0; i < current.size(); i++) {
+                summaries[i] = LatencyHistogram::summarize(current[i], latencyReported_[i]);
+            }
+            latencyReported_ = std::move(current);
+
+            if (summaries[0].count == 0) {
+                return;
             }
+
+            LogRecord* record = recordPool_.acquire();
+            record->level = LogLevel::Info;
+            record->timestamp = std::chrono::system_clock::now();
+            record->deferred = true;
+            LogArguments::pack(*record, "logcplus: latency of", summaries[0].count, "records (ns) queue wait p50", summaries[0].p50.count(),
+                               "p99", summaries[0].p99.count(), "max", summaries[0].max.count(), "| format p50", summaries[1].p50.count(),
+                               "p99", summaries[1].p99.count(), "max", summaries[1].max.count(), "| write p50", summaries[2].p50.count(),
+                               "p99", summaries[2].p99.count(), "max", summaries[2].max.count(), "| end to end p50",
+                               summaries[3].p50.count(), "p99", summaries[3].p99.count(), "max", summaries[3].max.count());
+            _records.push_back(record);
         }
 
         /**
-         * @brief Stops directory watcher.
+         * @brief Sets the overflow policy of the bounded message queue.
+         * @param _overflowPolicy What to do with a new message when the queue is full.
+         * @param _overflowLevel Messages below this level are dropped by OverflowPolicy::DropBelowLevel.
          */
-        void stop() {
-            if (timer_.isRunning()) {
-                timer_.stop();
-            }
+        void setOverflowPolicy(const OverflowPolicy _overflowPolicy, const LogLevel _overflowLevel) {
+            overflowPolicy_ = _overflowPolicy;
+            overflowLevel_ = _overflowLevel;
         }
 
         /**
-         * @brief Removes old log files. Called by local watcher timer with specified intervals.
+         * @brief Close log file.
          */
-        void removeOldLogFiles() {
-            std::vector<std::filesystem::path> filesToRemove = filesOlderThan(logDirectory_, std::chrono::milliseconds(fileExpiration_),
-                                                                              filePattern_);
-
-            try {
-                // Remove all files older than mFileExpiration
-                for (const auto& file: filesToRemove) {
-                    std::filesystem::remove(file);
+        void closeHandlers() {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            if (fileSink_.isOpen()) {
+                flushLocked();
+                if (syncPolicy_ != SyncPolicy::None) {
+                    fileSink_.sync();
                 }
-            } catch (const std::exception& ex) {
-                std::cerr << "logcplus: Unexpected error while deleting file " << ex.what() << std::endl;
+                crashDescriptor_.store(STDOUT_FILENO, std::memory_order_release);
+                fileSink_.close();
             }
         }
 
         /**
-         * @brief Checks file modification time with specified limit.
-         * @param _path File path (filename).
-         * @param _limit Expected last modification time.
+         * @brief Starts the new log file in the given directory (the existing file with the same name is moved aside).
+         *
+         * When the file is already open the reopen is performed by the queue worker between batches (open new file, then
+         * swap) and this call waits for it. Producers are never blocked and no message is written outside the log file.
          */
-        template<typename Rep, typename Period>
-        bool isFileOlderThan(const std::filesystem::path& _path, const std::chrono::duration<Rep, Period> _limit) const {
-            auto now = std::filesystem::file_time_type::clock::now();
-            return std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(now - std::filesystem::last_write_time(_path)) > _limit;
+        void reopen(const std::filesystem::path& _logDirectory) {
+            // Skip if it's we log on the console output.
+            if (logMode_ != LogMode::File) {
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(sinksMutex_);
+            if (fileSink_.isOpen() && work_.load(std::memory_order_acquire)) {
+                reopenDirectory_ = _logDirectory;
+                reopenRequested_.store(true, std::memory_order_release);
+                waitStrategy_.notify();
+
+                reopenedConditionVariable_.wait(lock, [this]() {
+                    return !reopenRequested_.load(std::memory_order_acquire) || !work_.load(std::memory_order_acquire);
+                });
+
+                // The worker was stopped in the meantime.
+                if (!reopenRequested_.load(std::memory_order_acquire)) {
+                    return;
+                }
+            }
+
+            reopenRequested_.store(false, std::memory_order_release);
+            flushLocked();
+            rotateLocked(_logDirectory);
+            lock.unlock();
+
+            // When it's a first initialization we need start log queue processing thread.
+            if (!work_.load(std::memory_order_acquire)) {
+                initialize();
+            }
         }
 
         /**
-         * @brief Checks the all files in the specified directory.
-         * @param _directory The Directory path (filename).
-         * @param _limit Expected last modification time.
-         * @param _fileNameRegex Optional file pattern (e.g. when we need remove only specified files).
+         * @brief Performs the reopen requested by `reopen` (queue worker only).
          */
-        template<typename Rep, typename Period>
-        std::vector<std::filesystem::path> filesOlderThan(const std::filesystem::path& _directory, const std::chrono::duration<Rep, Period> _limit,
-                                                          const std::string& _fileNameRegex = "") const {
-            std::vector<std::filesystem::path> result;
-            for (const auto& file: std::filesystem::recursive_directory_iterator(_directory)) {
-                // Check regular expression if defined.
-                // E.g. specified file name.
-                if (!_fileNameRegex.empty()) {
-                    const std::regex fileMatch(_fileNameRegex);
-                    if (!std::regex_match(std::filesystem::path(file.path()).filename().string(), fileMatch)) {
-                        continue;
-                    }
+        void processReopenRequest() {
+            if (reopenRequested_.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock(sinksMutex_);
+                if (reopenRequested_.load(std::memory_order_acquire)) {
+                    flushLocked();
+                    rotateLocked(reopenDirectory_);
+                    reopenRequested_.store(false, std::memory_order_release);
                 }
 
-                // Check last file modification.
-                if (std::filesystem::is_regular_file(file) && isFileOlderThan(file, _limit)) {
-                    result.push_back(file);
-                }
+                reopenedConditionVariable_.notify_all();
             }
-
-            return result;
         }
-    };
 
-    /**
-     * @brief
-     * The FileWatcher class is a extension around logger class. Allows you to create callback if the log
-     * file is more expensive as you thought or reopen file in specified time of day (checkpoint).
-     */
-    class FileWatcher {
-    public:
-        struct FileWatcherSettings;
+        /**
+         * @brief Installs (or restores previous) handlers of the fatal signals (SIGSEGV, SIGABRT, SIGBUS, SIGFPE).
+         *
+         * The handler asks the queue worker to write all pending messages followed by the Fatal line, waits for it (see
+         * LOGCPLUS_CRASH_FLUSH_TIMEOUT) and re-raises the signal with the previous action. The handler itself uses only
+         * async-signal-safe calls: the worker is woken through the eventfd (the waker thread notifies it) and if the
+         * worker doesn't respond (the worker crashed or the crashing thread holds the sinks lock) the Fatal line is written
+         * with raw write(2) to the log file (stdout or stderr if the log file is not opened in the append mode).
+         *
+         * The handler runs on the alternate signal stack, so SIGSEGV caused by the stack overflow is handled too. The
+         * alternate stack is per thread: it's installed only for the calling thread (other threads overflowing the stack
+         * are terminated without the handler unless they install their own alternate stack).
+         *
+         * Limitation: the queue worker flushing the pending messages can wait for a lock held by the crashing thread (e.g.
+         * allocator or sink internals), the handler waits for it at most LOGCPLUS_CRASH_FLUSH_TIMEOUT ms.
+         */
+        void setCrashHandler(const bool _enabled) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            if (_enabled == crashHandlerInstalled_) {
+                return;
+            }
 
-    private:
-        PreciseTimer timer_;
-        std::shared_ptr<FileWatcherSettings> fileWatcherSettings_;
-        std::function<void()> callback_;
+            if (_enabled) {
+                std::time_t now = std::time(nullptr);
+                std::tm local{};
+                localtime_r(&now, &local);
+                crashUtcOffset_ = local.tm_gmtoff;
+
+                // Condition variables can't be notified from the signal handler, the waker thread does it instead.
+                int descriptor = ::eventfd(0, EFD_CLOEXEC);
+                if (descriptor >= 0) {
+                    crashWakeDescriptor_.store(descriptor, std::memory_order_release);
+                    crashWaker_ = std::thread([this, descriptor]() {
+                        std::uint64_t value;
+                        while (::read(descriptor, &value, sizeof(value)) < 0 && errno == EINTR) {
+                        }
+
+                        if (crashSignal_.load(std::memory_order_acquire) != 0) {
+                            waitStrategy_.notifyAll();
+                        }
+                    });
+                } else {
+                    std::cerr << "logcplus: Cannot create the crash eventfd, the queue worker is polled: " << std::strerror(errno) << std::endl;
+                }
+
+                // Stack overflow leaves no stack for the handler.
+                if (!crashStack_) {
+                    crashStack_ = std::make_unique<char[]>(CRASH_STACK_SIZE);
+                }
 
-    public:
-        struct FileWatcherSettings {
-            // Path to the file.
-            std::filesystem::path filePath;
-            // We expect the file to be always smaller than the value below.
-            filesize_t maxFileSize;
-            // We can define when the watcher will execute callback method (e.g. specified time of day, it's optional).
-            std::optional<Date::Time> checkPoint;
-        };
+                stack_t stack{};
+                stack.ss_sp = crashStack_.get();
+                stack.ss_size = CRASH_STACK_SIZE;
+                if (::sigaltstack(&stack, &previousCrashStack_) != 0) {
+                    std::cerr << "logcplus: Cannot install the crash handler stack: " << std::strerror(errno) << std::endl;
+                }
 
-        FileWatcher() : fileWatcherSettings_(std::make_shared<FileWatcherSettings>()) {
+                struct sigaction action{};
+                action.sa_handler = &Logger::crashHandler;
+                action.sa_flags = SA_ONSTACK;
+                sigemptyset(&action.sa_mask);
+                for (std::size_t i = 0; i < CRASH_SIGNALS.size(); i++) {
+                    ::sigaction(CRASH_SIGNALS[i], &action, &previousCrashActions_[i]);
+                }
+            } else {
+                for (std::size_t i = 0; i < CRASH_SIGNALS.size(); i++) {
+                    ::sigaction(CRASH_SIGNALS[i], &previousCrashActions_[i], nullptr);
+                }
 
-        }
+                // The alternate stack is restored only on the thread which installed it (the buffer is kept).
+                stack_t current{};
+                if (::sigaltstack(nullptr, &current) == 0 && current.ss_sp == crashStack_.get() && !(current.ss_flags & SS_ONSTACK)) {
+                    ::sigaltstack(&previousCrashStack_, nullptr);
+                }
 
-        ~FileWatcher() {
-            // Stop timer and remove file handler if was not stopped yet.
-            stop();
-        }
+                // Waker returns without the crash signal set.
+                int descriptor = crashWakeDescriptor_.exchange(-1, std::memory_order_acq_rel);
+                if (descriptor >= 0) {
+                    wakeCrashWaker(descriptor);
+                    crashWaker_.join();
+                    ::close(descriptor);
+                }
+            }
 
-        FileWatcherSettings* settings() const {
-            return fileWatcherSettings_.get();
+            crashHandlerInstalled_ = _enabled;
         }
 
         /**
-         * @brief Starts file watcher timer.
-         * @param _callback Callback function.
-         * @param _checkInterval The timer interval in milliseconds, default: 1 min.
+         * @brief Wakes the crash waker thread (async-signal-safe).
          */
-        void start(std::function<void()> _callback, const unsigned long long _checkInterval = Timer<>::Seconds.SECOND * 60000) {
-            if (!timer_.isRunning()) {
-                callback_ = _callback;
-                timer_.startInterval(std::chrono::milliseconds(_checkInterval), [=] {
-                    isTimeToCallback();
-                });
+        static void wakeCrashWaker(const int _descriptor) {
+            const std::uint64_t value = 1;
+            while (::write(_descriptor, &value, sizeof(value)) < 0 && errno == EINTR) {
             }
         }
 
-        /**
-         * @brief Stops file watcher timer.
-         */
-        void stop() {
-            if (timer_.isRunning()) {
-                timer_.stop();
+        static void crashHandler(const int _signal) {
+            Logger* logger = instance_.load(std::memory_order_acquire);
+            if (logger) {
+                int expected = 0;
+                // Only the first crash is reported, other crashing threads wait for it.
+                if (logger->crashSignal_.compare_exchange_strong(expected, _signal, std::memory_order_acq_rel)) {
+                    if (int descriptor = logger->crashWakeDescriptor_.load(std::memory_order_acquire); descriptor >= 0) {
+                        wakeCrashWaker(descriptor);
+                    }
+
+                    if (!logger->waitForCrashFlush()) {
+                        logger->writeCrashLine(_signal);
+                    }
+                } else {
+                    logger->waitForCrashFlush();
+                }
+            }
+
+            for (std::size_t i = 0; i < CRASH_SIGNALS.size(); i++) {
+                if (CRASH_SIGNALS[i] == _signal) {
+                    ::sigaction(_signal, &previousCrashActions_[i], nullptr);
+                }
             }
+
+            ::raise(_signal);
         }
 
         /**
-         * @brief Timer callback. Creates a new log file if current size is similar(1) to the settings.
-         *
-         * (1) Similar because timer callback is executed every e.g. 1 min (default). The file may be larger in size if
-         *     logger produces more messages.
+         * @brief Waits until the queue worker writes pending messages after the crash (async-signal-safe).
+         * @return False if the worker didn't respond in time or the calling thread is the worker.
          */
-        void isTimeToCallback() {
-            std::error_code errorCode{};
-            Date::Time currTime = Date::currentTime();
+        bool waitForCrashFlush() {
+            long worker = workerThreadId_.load(std::memory_order_acquire);
+            if (worker == 0 || worker == static_cast<long>(::syscall(SYS_gettid))) {
+                return crashFlushed_.load(std::memory_order_acquire);
+            }
 
-            if (errorCode != std::error_code{}) {
-                std::cerr << "logcplus: Error when accessing to the file: " << fileWatcherSettings_->filePath << " error message: "
-                          << errorCode.message() << std::endl;
-                return;
+            struct timespec pause{0, 1000000};
+            for (int elapsed = 0; elapsed < LOGCPLUS_CRASH_FLUSH_TIMEOUT; elapsed++) {
+                if (crashFlushed_.load(std::memory_order_acquire)) {
+                    return true;
+                }
+
+                ::nanosleep(&pause, nullptr);
             }
 
-            // We check if there is the checkpoint (optional).
-            if (fileWatcherSettings_->checkPoint) {
-                // We skip second part (default watcher works with 1 min intervals).
-                if (fileWatcherSettings_->checkPoint->hour == currTime.hour && fileWatcherSettings_->checkPoint->minute == currTime.minute) {
-                    callback_();
+            return crashFlushed_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Writes the Fatal line in the default format with raw write(2) (async-signal-safe).
+         */
+        void writeCrashLine(const int _signal) const {
+            char line[128];
+            std::size_t length = 0;
+            auto append = [&line, &length](const char* _text) {
+                while (*_text && length < sizeof(line) - 1) {
+                    line[length++] = *_text++;
+                }
+            };
+            auto appendNumber = [&line, &length](long _value, int _digits) {
+                for (int digit = _digits - 1; digit >= 0 && length + digit < sizeof(line) - 1; digit--) {
+                    line[length + digit] = static_cast<char>('0' + _value % 10);
+                    _value /= 10;
                 }
+                length += static_cast<std::size_t>(_digits);
+            };
+
+            // Local time without localtime (days to civil date conversion).
+            long seconds = static_cast<long>(::time(nullptr)) + crashUtcOffset_;
+            long days = seconds / 86400, daySeconds = seconds % 86400;
+            if (daySeconds < 0) {
+                daySeconds += 86400;
+                days--;
             }
+            days += 719468;
+            long era = (days >= 0 ? days : days - 146096) / 146097;
+            long dayOfEra = days - era * 146097;
+            long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+            long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+            long monthIndex = (5 * dayOfYear + 2) / 153;
+            long day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+            long month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+            long year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+            append("[FATAL] ");
+            appendNumber(year, 4);
+            append("-");
+            appendNumber(month, 2);
+            append("-");
+            appendNumber(day, 2);
+            append(" ");
+            appendNumber(daySeconds / 3600, 2);
+            append(":");
+            appendNumber(daySeconds / 60 % 60, 2);
+            append(":");
+            appendNumber(daySeconds % 60, 2);
+            append(" - Fatal signal ");
+            append(signalName(_signal));
+            append(" received\n");
+
+            int descriptor = crashDescriptor_.load(std::memory_order_acquire);
+            const char* data = line;
+            while (length > 0) {
+                ssize_t written = ::write(descriptor, data, length);
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    break;
+                }
 
-            // We check if the file size has exceeded the set values.
-            std::uintmax_t currFileSize = std::filesystem::file_size(fileWatcherSettings_->filePath, errorCode);
-            if (currFileSize > fileWatcherSettings_->maxFileSize.bsize()) {
-                callback_();
+                data += written;
+                length -= static_cast<std::size_t>(written);
             }
         }
-    };
 
-    class LogManager;
+        static const char* signalName(const int _signal) {
+            switch (_signal) {
+                case SIGSEGV:
+                    return "SIGSEGV";
+                case SIGABRT:
+                    return "SIGABRT";
+                case SIGBUS:
+                    return "SIGBUS";
+                case SIGFPE:
+                    return "SIGFPE";
+                default:
+                    return "UNKNOWN";
+            }
+        }
 
-    /**
-     * @brief Basic c++ logger library.
-     */
-    class Logger {
-    public:
-        enum class LogMode;
-        enum class LogLevel;
+        /**
+         * @brief Writes all pending messages followed by the Fatal line after the crash (called by the queue worker).
+         * The log file is synced and closed (mapped file is truncated), the crash handler re-raises the signal then.
+         */
+        void processCrashRequest(std::vector<LogRecord*>& _batch) {
+            int signal = crashSignal_.load(std::memory_order_acquire);
+            if (signal == 0 || crashFlushed_.load(std::memory_order_acquire)) {
+                return;
+            }
 
-    private:
-        LogMode logMode_; // Logger mode (to Console / File)
-        LogLevel logLevel_; // Log level (see log level pyramid above)
-        std::streambuf* coutBuf_;
-        std::pair<std::ofstream, std::string> fileHandler_;
-        ConcurrentQueue<std::string> messageQueue_;
-        std::thread messageQueueWorker_;
-        std::atomic_bool work_, wait_;
+            while (messageQueue_->tryDequeueBulk(_batch, MAX_BATCH_SIZE) > 0) {
+                writeBatch(_batch);
+            }
 
-        inline static std::atomic<Logger*> instance_{nullptr};
-        inline static std::mutex instanceMutex_;
+            reportDroppedMessages(_batch);
+            LogRecord* record = recordPool_.acquire();
+            record->level = LogLevel::Fatal;
+            record->timestamp = std::chrono::system_clock::now();
+            record->deferred = true;
+            LogArguments::pack(*record, "Fatal signal", signalName(signal), "received");
+            _batch.push_back(record);
+            writeBatch(_batch);
+
+            {
+                std::lock_guard<std::mutex> lock(sinksMutex_);
+                flushLocked();
+                syncLocked();
+                if (fileSink_.isOpen()) {
+                    crashDescriptor_.store(STDERR_FILENO, std::memory_order_release);
+                    fileSink_.close();
+                }
+            }
 
-        friend class LogManager;
+            crashFlushed_.store(true, std::memory_order_release);
+        }
 
-    public:
-        enum class LogMode {
-            Console, File
-        };
+        /**
+         * @brief Concatenates variadic arguments to single string.
+         * @param _args Variadic arguments to concatenate
+         */
+        template<typename ...Args>
+        std::string concatenateLogArguments(const Args& ..._args) {
+            std::string result;
+            LogArguments::concatenate(result, _args...);
 
-        enum class LogLevel {
-            Debug, Info, Warn, Error, Fatal
-        };
+            return result;
+        }
 
         /**
-         * @brief Current opened file handler.
-         * @return Current filename.
+         * @brief Formats log timestamp on the caller thread (every thread has its own timestamp cache).
+         * @param _timePoint Time to format.
+         * @return Formatted timestamp, valid until the next call on this thread.
          */
-        std::string currentFile() const {
-            return fileHandler_.second;
+        std::string_view formatTimestamp(const std::chrono::system_clock::time_point _timePoint) const {
+            thread_local TimestampCache threadTimestampCache;
+            threadTimestampCache.setPrecision(timestampPrecision_.load(std::memory_order_relaxed));
+
+            return threadTimestampCache.format(_timePoint);
         }
 
         /**
-         * @brief Helper method with defined log level. See `log` method for details.
+         * @brief Get current time as string.
+         * @param _format Timestamp format, e.g %Y/%m/%d
          */
-        template<typename ...Args>
-        void debug(const Args& ..._args) {
-            if (logLevel_ <= Logger::LogLevel::Debug) {
-                log(LogLevel::Debug, _args...);
-            }
+        std::string currentTime(const std::string& _format) const {
+            return currentTime(_format, std::chrono::system_clock::now());
         }
 
         /**
-         * @brief Helper method with defined log level. See `log` method for details.
+         * @brief Get given time as string.
+         * @param _format Timestamp format, e.g %Y/%m/%d
+         * @param _timePoint Time to format.
          */
-        template<typename ...Args>
-        void info(const Args& ..._args) {
-            if (logLevel_ <= Logger::LogLevel::Info) {
-                log(LogLevel::Info, _args...);
-            }
+        std::string currentTime(const std::string& _format, const std::chrono::system_clock::time_point _timePoint) const {
+            auto in_time_t = std::chrono::system_clock::to_time_t(_timePoint);
+            std::tm localTime = Date::toLocalTime(in_time_t);
+
+            std::stringstream ss;
+            ss << std::put_time(&localTime, _format.c_str());
+
+            return ss.str();
         }
 
         /**
-         * @brief Helper method with defined log level. See `log` method for details.
+         * @brief Returns log enum type as string.
+         * @param _type Log type, e.g. Info
          */
-        template<typename ...Args>
-        void warn(const Args& ..._args) {
-            if (logLevel_ <= Logger::LogLevel::Warn) {
-                log(LogLevel::Warn, _args...);
-            }
+        std::string_view logTypeAsString(LogLevel _type) const {
+            return logLevelAsString(_type);
         }
 
         /**
-         * @brief Helper method with defined log level. See `log` method for details.
+         * @brief Sets when the coalesced messages are flushed to the output.
+         * @param _flushPolicy Flush policy.
+         * @param _flushInterval Flush interval (used by FlushPolicy::Interval).
+         * @param _flushBytes Flush size in bytes (used by FlushPolicy::Bytes).
          */
-        template<typename ...Args>
-        void error(const Args& ..._args) {
-            if (logLevel_ <= Logger::LogLevel::Error) {
-                log(LogLevel::Error, _args...);
-            }
+        void setFlushPolicy(const FlushPolicy _flushPolicy, const std::chrono::milliseconds _flushInterval, const std::size_t _flushBytes) {
+            flushPolicy_ = _flushPolicy;
+            flushInterval_ = _flushInterval;
+            flushBytes_ = _flushBytes;
         }
 
         /**
-         * @brief Helper method with defined log level. See `log` method for details.
+         * @brief Appends drained messages to the write buffer and flushes it according to the flush policy. Records are
+         * returned to the pool and the batch is cleared.
+         * @param _records Batch of messages drained from the queue.
          */
-        template<typename ...Args>
-        void fatal(const Args& ..._args) {
-            if (logLevel_ <= Logger::LogLevel::Fatal) {
-                log(LogLevel::Fatal, _args...);
+        void writeBatch(std::vector<LogRecord*>& _records) {
+            bool measured = latencyStatistics_.load(std::memory_order_acquire);
+            if (measured) {
+                auto now = std::chrono::steady_clock::now();
+                for (const auto* record: _records) {
+                    if (record->enqueueTime != std::chrono::steady_clock::time_point()) {
+                        queueWaitHistogram_.record(now - record->enqueueTime);
+                    }
+                }
+            }
+
+            collectBacktrace(_records);
+
+            std::size_t pendingBytes = 0;
+            bool syncError = false;
+            {
+                std::lock_guard<std::mutex> lock(sinksMutex_);
+                updateFormatterLevels();
+
+                // Error is written and synced right away (regardless of the flush policy).
+                if (syncPolicy_ == SyncPolicy::OnError) {
+                    syncError = std::any_of(_records.begin(), _records.end(), [](const LogRecord* _record) {
+                        return _record->level >= LogLevel::Error;
+                    });
+                }
+
+                // Every record is formatted once per formatter (not per sink).
+                for (auto& formatted: formattedLines_) {
+                    auto formatStart = measured ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+                    for (const auto* record: _records) {
+                        if (record->level >= formatted.level) {
+                            formatted.formatter->format(*record, formatted.buffer);
+                            formatted.buffer.push_back('\n');
+                            formatted.lines.emplace_back(record->level, formatted.buffer.size());
+
+                            // Consecutive measurements share the clock reading.
+                            if (measured) {
+                                auto formatEnd = std::chrono::steady_clock::now();
+                                formatHistogram_.record(formatEnd - formatStart);
+                                formatStart = formatEnd;
+                            }
+                        }
+                    }
+
+                    pendingBytes += formatted.buffer.size();
+                }
+
+                for (const auto* record: _records) {
+                    if (record->ringOffset != SharedMemoryRing::NO_OFFSET) {
+                        ringOffsets_.push_back(record->ringOffset);
+                    }
+                    if (measured && record->enqueueTime != std::chrono::steady_clock::time_point()) {
+                        pendingEnqueueTimes_.push_back(record->enqueueTime);
+                    }
+                }
+            }
+
+            // Formatted records go back to the pool.
+            for (auto* record: _records) {
+                recordPool_.release(record);
+            }
+            _records.clear();
+
+            if (syncError) {
+                flush();
+                return;
+            }
+
+            switch (flushPolicy_) {
+                case FlushPolicy::Interval:
+                    if (std::chrono::steady_clock::now() - lastFlush_ >= flushInterval_) {
+                        flush();
+                    }
+                    break;
+                case FlushPolicy::Bytes:
+                    if (pendingBytes >= flushBytes_) {
+                        flush();
+                    }
+                    break;
+                case FlushPolicy::EveryBatch:
+                default:
+                    flush();
+                    break;
             }
         }
 
         /**
-         * @brief Print log with timestamp.
-         * @param _args Log message parameters
+         * @brief Moves the backtrace records to the backtrace buffer. Buffered records are put before every Error or
+         * Fatal message and in place of the dump request.
+         * @param _records Batch of messages drained from the queue (replaced with the messages to write).
          */
-        template<typename ...Args>
-        void log(Logger::LogLevel _logLevel, const Args& ..._args) {
-            // Lock mutex (multithreading calls)
-            std::string header = "[" + logTypeAsString(_logLevel) + "]" + " " + currentTime("%Y-%m-%d %X") + " -";
-            std::string body = concatenateLogArguments(_args...);
+        void collectBacktrace(std::vector<LogRecord*>& _records) {
+            std::size_t capacity = backtraceSize_.load(std::memory_order_relaxed);
+            if (backtrace_.size() != capacity) {
+                resizeBacktrace(capacity);
+            }
+
+            if (backtraceCount_ == 0 && std::all_of(_records.begin(), _records.end(), [](const LogRecord* _record) {
+                return _record->kind == LogRecord::Kind::Message;
+            })) {
+                return;
+            }
+
+            backtraceBatch_.clear();
+            for (auto* record: _records) {
+                if (record->kind == LogRecord::Kind::Backtrace) {
+                    if (capacity == 0) {
+                        recordPool_.release(record);
+                        continue;
+                    }
+
+                    // The oldest record is overwritten.
+                    std::size_t index = (backtraceStart_ + backtraceCount_) % capacity;
+                    if (backtraceCount_ == capacity) {
+                        recordPool_.release(backtrace_[backtraceStart_]);
+                        backtraceStart_ = (backtraceStart_ + 1) % capacity;
+                    } else {
+                        backtraceCount_++;
+                    }
+                    backtrace_[index] = record;
+                } else if (record->kind == LogRecord::Kind::DumpBacktrace) {
+                    appendBacktrace(backtraceBatch_);
+                    recordPool_.release(record);
+                } else {
+                    if (record->level >= LogLevel::Error) {
+                        appendBacktrace(backtraceBatch_);
+                    }
+                    backtraceBatch_.push_back(record);
+                }
+            }
 
-            messageQueue_.enqueue(header.append(body));
+            _records.swap(backtraceBatch_);
         }
 
         /**
-         * @brief Adds file separator if not exits.
-         * @param _file Current full filename path
-         * @return Filename path with separator (optional if exists or is empty)
+         * @brief Moves records from the backtrace buffer (oldest first) between the backtrace begin and end messages.
          */
-        std::optional<std::string> addOptionalFileSeparator(const std::string& _file) {
-            if (!isFileExist(_file)) {
-                return std::nullopt;
+        void appendBacktrace(std::vector<LogRecord*>& _output) {
+            if (backtraceCount_ == 0) {
+                return;
             }
 
-            if (_file.size() > 0) {
-                if (_file[_file.length() - 1] != '/') {
-                    return std::string(_file + "/");
-                }
+            LogRecord* begin = recordPool_.acquire();
+            begin->level = LogLevel::Info;
+            begin->timestamp = std::chrono::system_clock::now();
+            begin->deferred = true;
+            LogArguments::pack(*begin, "logcplus: backtrace of", backtraceCount_, "messages");
+            _output.push_back(begin);
+
+            for (std::size_t i = 0; i < backtraceCount_; i++) {
+                _output.push_back(backtrace_[(backtraceStart_ + i) % backtrace_.size()]);
             }
 
-            return std::nullopt;
+            LogRecord* end = recordPool_.acquire();
+            end->level = LogLevel::Info;
+            end->timestamp = begin->timestamp;
+            end->deferred = true;
+            LogArguments::pack(*end, "logcplus: end of backtrace");
+            _output.push_back(end);
+
+            backtraceStart_ = 0;
+            backtraceCount_ = 0;
         }
 
         /**
-         * @brief Checks if given file exists.
-         * @param _path Full path to file (filename)
-         * @return If file exists => true
+         * @brief Changes the backtrace buffer capacity, the most recent records are kept.
          */
-        static bool isFileExist(const std::filesystem::path& _path, std::filesystem::file_status _status = std::filesystem::file_status()) {
-            if (std::filesystem::status_known(_status) ? std::filesystem::exists(_status) : std::filesystem::exists(_path)) {
-                return true;
+        void resizeBacktrace(const std::size_t _capacity) {
+            std::vector<LogRecord*> records;
+            records.reserve(_capacity);
+            for (std::size_t i = 0; i < backtraceCount_; i++) {
+                LogRecord* record = backtrace_[(backtraceStart_ + i) % backtrace_.size()];
+                if (backtraceCount_ - i > _capacity) {
+                    recordPool_.release(record);
+                } else {
+                    records.push_back(record);
+                }
             }
 
-            return false;
+            backtraceCount_ = records.size();
+            backtraceStart_ = 0;
+            records.resize(_capacity, nullptr);
+            backtrace_.swap(records);
         }
 
         /**
-         * @brief Checks if exists any files in given path.
-         * @param _directory Full path to directory to check
-         * @param _fileSought File sought
-         * @return Number of files found
+         * @brief Sets the lowest level of sinks using every formatter (sink levels can be changed at any time).
          */
-        static int anyFileExists(const std::string& _directory, const std::string& _fileSought) {
-            int count = 0;
+        void updateFormatterLevels() {
+            for (std::size_t i = 0; i < formattedLines_.size(); i++) {
+                formattedLines_[i].level = i == MAIN_SINK_LINES ? LogLevel::Debug : LogLevel::Fatal;
+            }
 
-            for (const auto& path: std::filesystem::directory_iterator(_directory)) {
-                std::string filename = path.path().filename();
+            for (std::size_t i = 0; i < sinks_.size(); i++) {
+                auto& formatted = formattedLines_[sinkFormatters_[i]];
+                formatted.level = std::min(formatted.level, sinks_[i]->level());
+            }
+        }
 
-                if (filename.find(_fileSought) != std::string::npos) {
-                    count++;
+        /**
+         * @brief Assigns formatted lines to the additional sinks (sinks with the same formatter share them).
+         */
+        void assignSinkFormatters() {
+            formattedLines_.resize(1);
+            sinkFormatters_.clear();
+
+            for (const auto& sink: sinks_) {
+                LogFormatter* formatter = sink->formatter() ? sink->formatter().get() : &defaultFormatter_;
+                auto formatted = std::find_if(formattedLines_.begin(), formattedLines_.end(), [formatter](const FormattedLines& _formatted) {
+                    return _formatted.formatter == formatter;
+                });
+
+                if (formatted == formattedLines_.end()) {
+                    formattedLines_.push_back({formatter, LogLevel::Debug, {}, {}});
+                    formatted = formattedLines_.end() - 1;
                 }
+
+                sinkFormatters_.push_back(static_cast<std::size_t>(formatted - formattedLines_.begin()));
             }
+        }
 
-            return count;
+        /**
+         * @brief Registers additional log sink. Pending messages are flushed to the current sinks first.
+         * @param _sink Log sink.
+         */
+        void addSink(std::shared_ptr<LogSink> _sink) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            flushLocked();
+            sinks_.push_back(std::move(_sink));
+            assignSinkFormatters();
         }
 
-    private:
-        Logger() : logMode_(Logger::LogMode::Console), logLevel_(Logger::LogLevel::Debug), work_(false), wait_(false) {}
+        /**
+         * @brief Unregisters additional log sink. Pending messages are flushed first.
+         * @param _sink Log sink.
+         */
+        void removeSink(const std::shared_ptr<LogSink>& _sink) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            flushLocked();
+            sinks_.erase(std::remove(sinks_.begin(), sinks_.end(), _sink), sinks_.end());
+            assignSinkFormatters();
+        }
 
-        Logger(const Logger&) = delete;
-        Logger& operator=(const Logger&) = delete;
+        /**
+         * @brief Writes lines with the sink level (or above) to the sink. Adjacent lines are written as a single span.
+         */
+        void writeLines(LogSink& _sink, const FormattedLines& _formatted) {
+            LogLevel level = _sink.level();
+            char* data = const_cast<char*>(_formatted.buffer.data());
+            std::size_t begin = 0;
+
+            writeSpans_.clear();
+            for (const auto& [lineLevel, end]: _formatted.lines) {
+                if (lineLevel >= level) {
+                    if (!writeSpans_.empty() && static_cast<char*>(writeSpans_.back().iov_base) + writeSpans_.back().iov_len == data + begin) {
+                        writeSpans_.back().iov_len += end - begin;
+                    } else {
+                        writeSpans_.push_back({data + begin, end - begin});
+                    }
+                }
 
-        ~Logger() {
-            stop();
+                begin = end;
+            }
+
+            if (!writeSpans_.empty()) {
+                _sink.write(writeSpans_.data(), writeSpans_.size());
+            }
         }
 
         /**
-         * @brief Gets current singleton instance. We allows only for one instance of logger.
-         * @return Logger instance
+         * @brief Writes lines to the log file. The file is rotated on the line boundary before it exceeds the max file
+         * size (a single line longer than the limit is written to the empty file).
+         * @return False if any write failed.
          */
-        static Logger* instance() {
-            if (instance_ == nullptr) {
-                std::lock_guard<std::mutex> lock(instanceMutex_);
-                if (instance_ == nullptr) {
-                    instance_ = new Logger();
+        bool writeFileLines(FormattedLines& _formatted) {
+            // Whole buffer fits into the file, it's taken over by the file sink (no copy for the asynchronous writes).
+            if (maxFileSize_ == 0 || fileSink_.size() + _formatted.buffer.size() <= maxFileSize_) {
+                return fileSink_.write(_formatted.buffer);
+            }
+
+            const char* data = _formatted.buffer.data();
+            std::size_t begin = 0, chunkBegin = 0;
+            bool written = true;
+
+            for (const auto& line: _formatted.lines) {
+                std::size_t end = line.second;
+                if (maxFileSize_ > 0 && fileSink_.size() + (end - chunkBegin) > maxFileSize_ && fileSink_.size() + (begin - chunkBegin) > 0) {
+                    written &= fileSink_.write(data + chunkBegin, begin - chunkBegin);
+                    rotateLocked(std::filesystem::path(fileSink_.path()).parent_path());
+                    chunkBegin = begin;
                 }
+
+                begin = end;
             }
 
-            return instance_;
+            if (begin > chunkBegin) {
+                written &= fileSink_.write(data + chunkBegin, begin - chunkBegin);
+            }
+
+            return written;
         }
 
         /**
-         * @brief Open log file (initialize ofstream handler). Redirects cout stream to file.
-         * @param _logDirectory Path to log directory
-         * @return Successfully initialized.
+         * @brief Starts the new log file (sinks mutex must be locked). The existing file with the same name is moved to the
+         * next free `.N` name (the open descriptor stays valid), the new file is opened and swapped with the current one.
+         * The previous file is closed on the background thread.
+         * @param _logDirectory Log directory.
          */
-        void initialize(std::string& _logDirectory, const std::string& _filename) {
-            if (logMode_ != Logger::LogMode::File) {
-                return;
-            }
+        void rotateLocked(const std::filesystem::path& _logDirectory) {
+            std::error_code errorCode;
+            std::filesystem::create_directories(_logDirectory, errorCode);
 
-            wait_.store(true, std::memory_order_release); // Information for processing queue that should wait until we create a new file handler.
-            fileHandler_.first.exceptions(std::ofstream::badbit);
+            std::string filename = currentTime("%Y-%m-%d") + ".log";
+            std::filesystem::path path = _logDirectory / filename;
 
-            // Create missing directory if was specified (not exists).
-            if (!isFileExist(_logDirectory)) {
-                std::filesystem::create_directories(_logDirectory);
+            // The index is looked up in the directory only once per file name.
+            if (path != rotationPath_) {
+                rotationPath_ = path;
+                rotationIndex_ = nextRotationIndex(_logDirectory, filename);
             }
 
-            try {
-                if (!fileHandler_.first.is_open()) {
-                    if (std::optional<std::string> path = addOptionalFileSeparator(_logDirectory); path.has_value()) {
-                        _logDirectory = path.value();
-                    }
-
-                    std::string fullPath = _logDirectory + _filename;
-                    fileHandler_.first.open(fullPath, std::ios::out | std::ios::app);
-                    fileHandler_.second = fullPath;
-
-                    // Redirect cout stream to file.
-                    coutBuf_ = std::cout.rdbuf();
-                    std::cout.rdbuf(fileHandler_.first.rdbuf());
+            std::string rotatedPath = path.string() + "." + std::to_string(rotationIndex_);
+            std::filesystem::rename(path, rotatedPath, errorCode);
+            bool compress = false, truncateTail = false;
+            if (!errorCode) {
+                rotationIndex_++;
+                compress = compression_ == Compression::Gzip;
+                // File found on start may be the mapped file of the killed process (padded with zeros).
+                truncateTail = !fileSink_.isOpen();
+                counters_.add(ROTATIONS_COUNTER);
+            } else if (errorCode != std::errc::no_such_file_or_directory) {
+                std::cerr << "logcplus: Cannot rotate the log file " << path << ": " << errorCode.message() << std::endl;
+            }
 
-                    // When it's a first initialization we need start log queue processing thread.
-                    if (!work_.load(std::memory_order::memory_order_acquire)) {
-                        initialize();
+            fileSink_.setSegmentSize(fileBackend_ == FileBackend::Mmap ? (maxFileSize_ > 0 ? maxFileSize_ : FileSink::DEFAULT_SEGMENT_SIZE) : 0);
+            fileSink_.setAsyncWrites(fileBackend_ == FileBackend::IoUring);
+            // The rest of the previous file is synced before the swap.
+            if (syncPolicy_ != SyncPolicy::None && fileSink_.isOpen()) {
+                fileSink_.sync();
+            }
+            FileSink::Handle previous = fileSink_.reopen(path.string());
+            int descriptor = fileSink_.appendDescriptor();
+            crashDescriptor_.store(descriptor >= 0 ? descriptor : STDERR_FILENO, std::memory_order_release);
+
+            // The rotated file is compressed when it's released (mapped files are truncated to the written size first).
+            if (previous.fd >= 0 || compress || truncateTail) {
+                backgroundTasks_.submit([this, previous, compress, truncateTail, rotatedPath]() {
+                    FileSink::release(previous);
+                    if (truncateTail) {
+                        FileSink::truncateZeroTail(rotatedPath);
                     }
+                    if (compress) {
+                        compressionTasks_.submit([rotatedPath]() {
+                            FileCompressor::gzip(rotatedPath);
+                        });
+                    }
+                });
+            }
+        }
+
+        /**
+         * @brief Finds the next free `.N` suffix of the rotated log files.
+         * @param _logDirectory Log directory.
+         * @param _filename Log file name.
+         */
+        static std::size_t nextRotationIndex(const std::filesystem::path& _logDirectory, const std::string& _filename) {
+            std::size_t index = 1;
+            std::error_code errorCode;
+
+            for (const auto& entry: std::filesystem::directory_iterator(_logDirectory, errorCode)) {
+                std::string name = entry.path().filename().string();
+                if (name.size() > _filename.size() + 1 && name.compare(0, _filename.size(), _filename) == 0 && name[_filename.size()] == '.') {
+                    index = std::max<std::size_t>(index, std::strtoull(name.c_str() + _filename.size() + 1, nullptr, 10) + 1);
                 }
-            } catch (const std::ofstream::failure& _ex) {
-                std::cerr << "[" + logTypeAsString(LogLevel::Fatal) + "]" << "[" + currentTime("%Y-%m-%d %X") + "] " << _ex.what() << std::endl;
             }
 
-            wait_.store(false, std::memory_order_release);
+            return index;
         }
 
         /**
-         * @brief Runs queue worker.
-         * @return Successfully initialized.
+         * @brief Sets how the log file is written (applied to the next opened file).
          */
-        void initialize() {
-            processQueue();
+        void setFileBackend(const FileBackend _fileBackend) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            fileBackend_ = _fileBackend;
         }
 
         /**
-         * @brief Close log file.
+         * @brief Sets compression of the rotated log files.
          */
-        void closeHandlers() {
-            if (fileHandler_.first.is_open()) {
-                wait_.store(true, std::memory_order_release);
+        void setCompression(Compression _compression) {
+            if (_compression == Compression::Gzip && !FileCompressor::isGzipAvailable()) {
+                std::cerr << "logcplus: Gzip compression is not available (built without LOGCPLUS_WITH_ZLIB)" << std::endl;
+                _compression = Compression::None;
+            }
 
-                std::cout.rdbuf(coutBuf_);
-                if (fileHandler_.first.is_open()) {
-                    fileHandler_.first.close();
-                }
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            compression_ = _compression;
+        }
 
-                wait_.store(false, std::memory_order_release);
-            }
+        /**
+         * @brief Sets the max log file size (0 - unlimited).
+         */
+        void setMaxFileSize(const std::uintmax_t _maxFileSize) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            maxFileSize_ = _maxFileSize;
         }
 
         /**
-         * @brief Closes last file handler and creates new.
+         * @brief Sets when the written messages are synced to the disk.
+         * @param _syncPolicy Sync policy.
+         * @param _syncInterval Sync interval (used by SyncPolicy::Periodic).
          */
-        void reopen(std::string _logDirectory) {
-            // Skip if it's we log on the console output.
-            if (logMode_ != LogMode::File) {
-                return;
-            }
+        void setSyncPolicy(const SyncPolicy _syncPolicy, const std::chrono::milliseconds _syncInterval) {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            syncPolicy_ = _syncPolicy;
+            syncInterval_ = _syncInterval;
+        }
 
-            if (!Logger::isFileExist(_logDirectory)) {
-                std::filesystem::create_directories(_logDirectory);
+        /**
+         * @brief Syncs the log file and all additional sinks (sinks mutex must be locked).
+         */
+        void syncLocked() {
+            if (logMode_ == LogMode::File && fileSink_.isOpen()) {
+                fileSink_.sync();
             }
 
-            std::string filename = currentTime("%Y-%m-%d") + ".log";
+            for (auto& sink: sinks_) {
+                sink->sync();
+            }
 
-            // Check if the file with same date exists.
-            int count = anyFileExists(_logDirectory, filename);
+            unsynced_ = false;
+            lastSync_ = std::chrono::steady_clock::now();
+        }
 
-            // Close current file handler.
-            closeHandlers();
+        /**
+         * @brief Syncs written messages when the periodic sync interval elapsed.
+         */
+        void syncIfDue() {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            if (syncPolicy_ == SyncPolicy::Periodic && unsynced_ && std::chrono::steady_clock::now() - lastSync_ >= syncInterval_) {
+                syncLocked();
+            }
+        }
 
-            // If its another log file on this day we append to current filename number of file
-            // with the same name (date).
-            if (count != 0) {
-                std::optional<std::string> dir = addOptionalFileSeparator(_logDirectory);
-                if (dir.has_value()) {
-                    _logDirectory = dir.value();
+        /**
+         * @brief Writes formatted messages to all sinks (sinks mutex must be locked).
+         */
+        void flushLocked() {
+            bool written = false, error = false;
+            for (const auto& formatted: formattedLines_) {
+                written |= !formatted.lines.empty();
+                for (const auto& line: formatted.lines) {
+                    error |= line.first >= LogLevel::Error;
                 }
+            }
 
-                std::string fullPath = _logDirectory + filename;
-                std::string filenameSufix = "." + std::to_string(count); // Append file number
-                std::filesystem::rename(fullPath, fullPath + filenameSufix);
+            bool measured = written && latencyStatistics_.load(std::memory_order_acquire);
+            auto writeStart = measured ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+            // Additional sinks go first, the log file may take over the main buffer.
+            for (std::size_t i = 0; i < sinks_.size(); i++) {
+                writeLines(*sinks_[i], formattedLines_[sinkFormatters_[i]]);
             }
 
-            // Create the new log file.
-            initialize(_logDirectory, currentTime("%Y-%m-%d") + ".log");
-        }
+            FormattedLines& main = formattedLines_[MAIN_SINK_LINES];
+            std::size_t mainBytes = main.buffer.size();
+            bool mainWritten = true;
+            if (logMode_ == LogMode::File && fileSink_.isOpen()) {
+                mainWritten = writeFileLines(main);
+                if (std::uint64_t failed = fileSink_.takeFailedWrites(); failed > 0) {
+                    counters_.add(WRITE_ERRORS_COUNTER, failed);
+                }
+            } else {
+                writeLines(consoleSink_, main);
+            }
 
-        /**
-         * @brief Concatenates variadic arguments to single string.
-         * @param _args Variadic arguments to concatenate
-         */
-        template<typename ...Args>
-        std::string concatenateLogArguments(const Args& ..._args) {
-            std::string result;
-            using ::to_string;
-            using std::to_string;
+            if (!mainWritten) {
+                counters_.add(WRITE_ERRORS_COUNTER);
+            } else if (!main.lines.empty()) {
+                std::uint64_t lines[5] = {};
+                for (const auto& line: main.lines) {
+                    lines[static_cast<std::size_t>(line.first)]++;
+                }
 
-            int unpack[]{0, (result += " " + to_string(_args), 0)...};
-            static_cast<void>(unpack);
+                for (std::size_t level = 0; level < 5; level++) {
+                    if (lines[level] > 0) {
+                        counters_.add(WRITTEN_COUNTER + level, lines[level]);
+                    }
+                }
+                counters_.add(BYTES_WRITTEN_COUNTER, mainBytes);
+            }
 
-            return result;
-        }
+            if (measured) {
+                auto writeEnd = std::chrono::steady_clock::now();
+                writeHistogram_.record(writeEnd - writeStart);
+                for (auto enqueueTime: pendingEnqueueTimes_) {
+                    endToEndHistogram_.record(writeEnd - enqueueTime);
+                }
+            }
+            pendingEnqueueTimes_.clear();
 
-        /**
-         * @brief Get current time as string.
-         * @param _format Timestamp format, e.g %Y/%m/%d
-         */
-        std::string currentTime(const std::string& _format) const {
-            auto now = std::chrono::system_clock::now();
-            auto in_time_t = std::chrono::system_clock::to_time_t(now);
+            for (auto& formatted: formattedLines_) {
+                formatted.buffer.clear();
+                formatted.lines.clear();
+            }
 
-            std::stringstream ss;
-            ss << std::put_time(std::localtime(&in_time_t), _format.c_str());
+            unsynced_ |= written;
+            if (unsynced_ && (syncPolicy_ == SyncPolicy::EveryBatch || (syncPolicy_ == SyncPolicy::OnError && error) ||
+                              (syncPolicy_ == SyncPolicy::Periodic && std::chrono::steady_clock::now() - lastSync_ >= syncInterval_))) {
+                syncLocked();
+            }
 
-            return ss.str();
+            // Written records are not needed in the shared memory ring anymore.
+            if (!ringOffsets_.empty()) {
+                if (SharedMemoryRing* ring = sharedRing_.load(std::memory_order_acquire)) {
+                    for (auto offset: ringOffsets_) {
+                        ring->consume(offset);
+                    }
+                    ring->advance();
+                }
+                ringOffsets_.clear();
+            }
         }
 
         /**
-         * @brief Returns log enum type as string.
-         * @param _type Log type, e.g. Info
+         * @brief Writes coalesced messages to all sinks (a single write call per sink if possible).
          */
-        std::string logTypeAsString(LogLevel _type) const {
-            switch (_type) {
-                case LogLevel::Info:
-                    return "INFO";
-                case LogLevel::Warn:
-                    return "WARN";
-                case LogLevel::Debug:
-                    return "DEBUG";
-                case LogLevel::Error:
-                    return "ERROR";
-                case LogLevel::Fatal:
-                    return "FATAL";
-                default:
-                    return "UNKNOWN";
-            }
+        void flush() {
+            std::lock_guard<std::mutex> lock(sinksMutex_);
+            flushLocked();
+            lastFlush_ = std::chrono::steady_clock::now();
         }
 
         /**
@@ -1371,28 +5911,74 @@ namespace dev::marcinromanowski::logcplus {
             work_.store(true, std::memory_order_release);
 
             messageQueueWorker_ = std::thread([&]() {
+                std::vector<LogRecord*> batch;
+                batch.reserve(MAX_BATCH_SIZE);
+                lastFlush_ = std::chrono::steady_clock::now();
+
+                workerThreadId_.store(static_cast<long>(::syscall(SYS_gettid)), std::memory_order_release);
+
                 while (work_.load(std::memory_order_acquire)) {
-                    if (!messageQueue_.empty() && !wait_.load(std::memory_order_acquire)) {
-                        std::cout << messageQueue_.dequeue() << std::endl;
+                    processReopenRequest();
+                    processCrashRequest(batch);
+
+                    if (messageQueue_->tryDequeueBulk(batch, MAX_BATCH_SIZE) > 0) {
+                        reportDroppedMessages(batch);
+                        reportLatency(batch);
+                        writeBatch(batch);
                     } else {
-                        std::this_thread::sleep_for(std::chrono::seconds(1));
+                        if (flushPolicy_ == FlushPolicy::Interval && std::chrono::steady_clock::now() - lastFlush_ >= flushInterval_) {
+                            flush();
+                        }
+                        syncIfDue();
+
+                        // Blocks until a producer enqueues a message (or the worker is stopped).
+                        waitStrategy_.wait([this]() {
+                            return !work_.load(std::memory_order_acquire) || reopenRequested_.load(std::memory_order_acquire) ||
+                                   !messageQueue_->empty() || (crashSignal_.load(std::memory_order_acquire) != 0 &&
+                                                               !crashFlushed_.load(std::memory_order_acquire));
+                        }, std::min(flushInterval_, std::chrono::milliseconds(100)));
                     }
                 }
+
+                // Pending reopen is finished by the waiting caller.
+                {
+                    std::lock_guard<std::mutex> lock(sinksMutex_);
+                    reopenedConditionVariable_.notify_all();
+                }
+
+                // Write all remaining messages before exit.
+                while (messageQueue_->tryDequeueBulk(batch, MAX_BATCH_SIZE) > 0) {
+                    writeBatch(batch);
+                }
+
+                reportDroppedMessages(batch);
+                writeBatch(batch);
+
+                flush();
+                workerThreadId_.store(0, std::memory_order_release);
             });
         }
 
         /**
-         * @brief Closes all log file handlers and stops processing thread.
+         * @brief Stops processing thread (remaining messages are written) and closes all log file handlers.
          */
         void stop() {
-            // Close all file handlers.
-            closeHandlers();
-
             // Wait for thread execution.
             work_.store(false, std::memory_order_release);
+            waitStrategy_.notifyAll();
             if (messageQueueWorker_.joinable()) {
                 messageQueueWorker_.join();
             }
+
+            // Close all file handlers.
+            closeHandlers();
+            backgroundTasks_.stop();
+            compressionTasks_.stop();
+
+            // All records are written, the ring file is not needed.
+            if (SharedMemoryRing* ring = sharedRing_.exchange(nullptr, std::memory_order_acq_rel)) {
+                ring->unlink();
+            }
         }
     };
 
@@ -1402,127 +5988,379 @@ namespace dev::marcinromanowski::logcplus {
         struct LoggerConfiguration {
             // Default: current directory.
             std::filesystem::path logDirectoryPath = std::filesystem::current_path();
-            // Default: 50 MB for single log file.
-            filesize_t maxLogFileSize = filesize_t(50, filesize_t::SizeUnit::MB);
+            // Default: unlimited (0), the log file is not rotated.
+            filesize_t maxLogFileSize = filesize_t(0, filesize_t::SizeUnit::B);
             // Default: log file will be not remove
             unsigned long long removeLogsOlderThan = 0;
             // Default: all logs will be printed (see Logger class for details).
             Logger::LogLevel logLevel = Logger::LogLevel::Debug;
             // Default: logs will be printed on the console.
             Logger::LogMode logMode = Logger::LogMode::Console;
+            // Default: log messages are formatted on the caller thread.
+            Logger::FormattingMode formattingMode = Logger::FormattingMode::Eager;
+            // Default: log timestamp with seconds precision.
+            TimestampCache::Precision timestampPrecision = TimestampCache::Precision::Seconds;
             // Default: not used.
             std::optional<Date::Time> checkPoint = std::nullopt;
             // Default: not enabled.
             bool enableFileWatcher = false;
             // Default: not enabled.
             bool enableAutoRemove = false;
+            // Default: not enabled (fatal signals are not handled by the logger).
+            bool enableCrashHandler = false;
+            // Default: not enabled (queued messages are kept only in the process memory).
+            bool enableSharedMemoryRing = false;
+            // Default: 16 MiB (used by the shared memory ring).
+            filesize_t sharedMemoryRingSize = filesize_t(16, filesize_t::SizeUnit::MiB);
+            // Default: messages below the log level are not kept.
+            std::size_t backtraceSize = 0;
+            // Default: unbounded queue guarded by the mutex.
+            Logger::QueueType queueType = Logger::QueueType::Locked;
+            // Default: unbounded locked queue, 65536 messages for the lock-free queues.
+            std::size_t queueCapacity = 0;
+            // Default: producer waits for a free space in the full queue.
+            Logger::OverflowPolicy overflowPolicy = Logger::OverflowPolicy::Block;
+            // Default: Error and Fatal messages are never dropped (used by the DropBelowLevel overflow policy).
+            Logger::LogLevel overflowLevel = Logger::LogLevel::Error;
+            // Default: messages are flushed after every drained batch.
+            Logger::FlushPolicy flushPolicy = Logger::FlushPolicy::EveryBatch;
+            // Default: 100 ms (used by the interval flush policy).
+            std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100);
+            // Default: 64 KiB (used by the bytes flush policy).
+            filesize_t flushBytes = filesize_t(64, filesize_t::SizeUnit::KiB);
+            // Default: rotated log files are not compressed.
+            Logger::Compression compression = Logger::Compression::None;
+            // Default: log file is written with write(2).
+            Logger::FileBackend fileBackend = Logger::FileBackend::Write;
+            // Default: written messages are not synced explicitly.
+            Logger::SyncPolicy syncPolicy = Logger::SyncPolicy::None;
+            // Default: 1 s (used by the periodic sync policy).
+            std::chrono::milliseconds syncInterval = std::chrono::milliseconds(1000);
+            // Default: not enabled (records are not stamped with the enqueue time).
+            bool enableLatencyStatistics = false;
+            // Default: latency is not reported in the log (used by the latency statistics).
+            std::chrono::milliseconds latencyReportInterval = std::chrono::milliseconds(0);
+
+            std::string toString() const {
+                return "Logcplus settings"
+                       "\n\tLogDirectoryPath: " + logDirectoryPath.string() + "\n\tMaxLogFileSize: " + maxLogFileSize.toString() + "\n\tLogLevel: " +
+                       std::to_string(static_cast<int>(logLevel)) + "\n\tLogMode: " + std::to_string(static_cast<int>(logMode)) + "\n\tFormattingMode: " +
+                       std::to_string(static_cast<int>(formattingMode)) + "\n\tTimestampPrecision: " +
+                       std::to_string(static_cast<int>(timestampPrecision)) + "\n\tCheckPoint: " +
+                       (checkPoint.has_value() ? checkPoint.value().toString() : "undefined") + "\n\tRemoveLogsOlderThan: " +
+                       std::to_string(removeLogsOlderThan) + "ms" + "\n\tEnableFileWatcher: " + (enableFileWatcher ? "true" : "false") +
+                       "\n\tEnableAutoRemove: " + (enableAutoRemove ? "true" : "false") + "\n\tEnableCrashHandler: " +
+                       (enableCrashHandler ? "true" : "false") + "\n\tEnableSharedMemoryRing: " + (enableSharedMemoryRing ? "true" : "false") +
+                       "\n\tSharedMemoryRingSize: " + sharedMemoryRingSize.toString() + "\n\tBacktraceSize: " + std::to_string(backtraceSize) +
+                       "\n\tQueueType: " +
+                       std::to_string(static_cast<int>(queueType)) + "\n\tQueueCapacity: " + std::to_string(queueCapacity) +
+                       "\n\tOverflowPolicy: " + std::to_string(static_cast<int>(overflowPolicy)) + "\n\tOverflowLevel: " +
+                       std::to_string(static_cast<int>(overflowLevel)) + "\n\tFlushPolicy: " + std::to_string(static_cast<int>(flushPolicy)) +
+                       "\n\tFlushInterval: " + std::to_string(flushInterval.count()) + "ms" + "\n\tFlushBytes: " + flushBytes.toString() +
+                       "\n\tCompression: " + std::to_string(static_cast<int>(compression)) + "\n\tFileBackend: " +
+                       std::to_string(static_cast<int>(fileBackend)) + "\n\tSyncPolicy: " + std::to_string(static_cast<int>(syncPolicy)) +
+                       "\n\tSyncInterval: " + std::to_string(syncInterval.count()) + "ms" + "\n\tEnableLatencyStatistics: " +
+                       (enableLatencyStatistics ? "true" : "false") + "\n\tLatencyReportInterval: " +
+                       std::to_string(latencyReportInterval.count()) + "ms";
+            }
+        };
+
+    public:
+        /**
+         * @brief
+         * Loads logcplus configuration file and make basic parse of the all values.
+         *
+         * We expect file format like:
+         * ---
+         * LogDirectoryPath /home/user/logs
+         * MaxLogFileSize 100MiB
+         * RemoveLogsOlderThan 1d
+         * LogLevel Info
+         * LogMode File
+         * FormattingMode Deferred
+         * TimestampPrecision Milliseconds
+         * CheckPoint 11:45
+         * EnableFileWatcher true
+         * EnableAutoRemove true
+         * EnableCrashHandler true
+         * EnableSharedMemoryRing true
+         * SharedMemoryRingSize 16MiB
+         * BacktraceSize 256
+         * QueueType LockFree
+         * QueueCapacity 65536
+         * OverflowPolicy DropBelowLevel
+         * OverflowLevel Error
+         * FlushPolicy Interval
+         * FlushInterval 250
+         * FlushBytes 64KiB
+         * Compression Gzip
+         * FileBackend Mmap
+         * SyncPolicy OnError
+         * SyncInterval 1000
+         * EnableLatencyStatistics true
+         * LatencyReportInterval 60000
+         * ---
+         *
+         * If we not define all options we choose default (predefined) values.
+         *
+         * @param _filePath Path to the configuration file.
+         * @return LoggerConfiguration instance contains default / loaded configuration options.
+         */
+        static LoggerConfiguration load(const std::filesystem::path& _filePath) {
+            LoggerConfiguration config;
+            EMap mapController;
+
+            if (bool status = mapController.read(_filePath); status && mapController.data().size() > 0) {
+                try {
+                    // LogDirectoryPath
+                    if (auto optValue = contains(mapController, "LogDirectoryPath"); optValue.has_value()) {
+                        config.logDirectoryPath = std::any_cast<std::string>(optValue);
+                    }
+
+                    // MaxLogFileSize
+                    if (auto optValue = contains(mapController, "MaxLogFileSize"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseMaxLogFileSize(castedValue); result.has_value()) {
+                            config.maxLogFileSize = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // RemoveLogsOlderThan
+                    if (auto optValue = contains(mapController, "RemoveLogsOlderThan"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto value = parseRemoveLogsOlderThan(castedValue); value != 0) {
+                            config.removeLogsOlderThan = value;
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // LogLevel
+                    if (auto optValue = contains(mapController, "LogLevel"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseLogLevel(castedValue)) {
+                            config.logLevel = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // LogMode
+                    if (auto optValue = contains(mapController, "LogMode"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseLogMode(castedValue); result.has_value()) {
+                            config.logMode = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // FormattingMode
+                    if (auto optValue = contains(mapController, "FormattingMode"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseFormattingMode(castedValue); result.has_value()) {
+                            config.formattingMode = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // TimestampPrecision
+                    if (auto optValue = contains(mapController, "TimestampPrecision"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseTimestampPrecision(castedValue); result.has_value()) {
+                            config.timestampPrecision = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // CheckPoint
+                    if (auto optValue = contains(mapController, "CheckPoint"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseCheckPoint(castedValue); result.has_value()) {
+                            config.checkPoint = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // EnableFileWatcher
+                    if (auto optValue = contains(mapController, "EnableFileWatcher"); optValue.has_value()) {
+                        config.enableFileWatcher = std::any_cast<bool>(optValue);
+                    }
+
+                    // EnableAutoRemove
+                    if (auto optValue = contains(mapController, "EnableAutoRemove"); optValue.has_value()) {
+                        config.enableAutoRemove = std::any_cast<bool>(optValue);
+                    }
+
+                    // EnableCrashHandler
+                    if (auto optValue = contains(mapController, "EnableCrashHandler"); optValue.has_value()) {
+                        config.enableCrashHandler = std::any_cast<bool>(optValue);
+                    }
+
+                    // EnableSharedMemoryRing
+                    if (auto optValue = contains(mapController, "EnableSharedMemoryRing"); optValue.has_value()) {
+                        config.enableSharedMemoryRing = std::any_cast<bool>(optValue);
+                    }
+
+                    // BacktraceSize (messages)
+                    if (auto optValue = contains(mapController, "BacktraceSize"); optValue.has_value()) {
+                        if (int castedValue = std::any_cast<int>(optValue); castedValue >= 0) {
+                            config.backtraceSize = static_cast<std::size_t>(castedValue);
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // SharedMemoryRingSize
+                    if (auto optValue = contains(mapController, "SharedMemoryRingSize"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = filesize_t::parseFileSize(castedValue); result.has_value()) {
+                            config.sharedMemoryRingSize = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // QueueType
+                    if (auto optValue = contains(mapController, "QueueType"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseQueueType(castedValue); result.has_value()) {
+                            config.queueType = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // QueueCapacity
+                    if (auto optValue = contains(mapController, "QueueCapacity"); optValue.has_value()) {
+                        if (int castedValue = std::any_cast<int>(optValue); castedValue >= 0) {
+                            config.queueCapacity = static_cast<std::size_t>(castedValue);
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
 
-            std::string toString() const {
-                return "Logcplus settings"
-                       "\n\tLogDirectoryPath: " + logDirectoryPath.string() + "\n\tMaxLogFileSize: " + maxLogFileSize.toString() + "\n\tLogLevel: " +
-                       std::to_string(static_cast<int>(logLevel)) + "\n\tLogMode: " + std::to_string(static_cast<int>(logMode)) + "\n\tCheckPoint: " +
-                       (checkPoint.has_value() ? checkPoint.value().toString() : "undefined") + "\n\tRemoveLogsOlderThan: " +
-                       std::to_string(removeLogsOlderThan) + "ms" + "\n\tEnableFileWatcher: " + (enableFileWatcher ? "true" : "false") +
-                       "\n\tEnableAutoRemove: " + (enableAutoRemove ? "true" : "false");
-            }
-        };
+                    // OverflowPolicy
+                    if (auto optValue = contains(mapController, "OverflowPolicy"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
 
-    public:
-        /**
-         * @brief
-         * Loads logcplus configuration file and make basic parse of the all values.
-         *
-         * We expect file format like:
-         * ---
-         * LogDirectoryPath /home/user/logs
-         * MaxLogFileSize 100MiB
-         * RemoveLogsOlderThan 1d
-         * LogLevel Info
-         * LogMode File
-         * CheckPoint 11:45
-         * EnableFileWatcher true
-         * EnableAutoRemove true
-         * ---
-         *
-         * If we not define all options we choose default (predefined) values.
-         *
-         * @param _filePath Path to the configuration file.
-         * @return LoggerConfiguration instance contains default / loaded configuration options.
-         */
-        static LoggerConfiguration load(const std::filesystem::path& _filePath) {
-            LoggerConfiguration config;
-            EMap mapController;
+                        if (auto result = parseOverflowPolicy(castedValue); result.has_value()) {
+                            config.overflowPolicy = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
 
-            if (bool status = mapController.read(_filePath); status && mapController.data().size() > 0) {
-                try {
-                    // LogDirectoryPath
-                    if (auto optValue = contains(mapController, "LogDirectoryPath"); optValue.has_value()) {
-                        config.logDirectoryPath = std::any_cast<std::string>(optValue);
+                    // OverflowLevel
+                    if (auto optValue = contains(mapController, "OverflowLevel"); optValue.has_value()) {
+                        std::string castedValue = std::any_cast<std::string>(optValue);
+
+                        if (auto result = parseLogLevel(castedValue); result.has_value()) {
+                            config.overflowLevel = result.value();
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
                     }
 
-                    // MaxLogFileSize
-                    if (auto optValue = contains(mapController, "MaxLogFileSize"); optValue.has_value()) {
+                    // FlushPolicy
+                    if (auto optValue = contains(mapController, "FlushPolicy"); optValue.has_value()) {
                         std::string castedValue = std::any_cast<std::string>(optValue);
 
-                        if (auto result = parseMaxLogFileSize(castedValue); result.has_value()) {
-                            config.maxLogFileSize = result.value();
+                        if (auto result = parseFlushPolicy(castedValue); result.has_value()) {
+                            config.flushPolicy = result.value();
                         } else {
                             std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
                         }
                     }
 
-                    // RemoveLogsOlderThan
-                    if (auto optValue = contains(mapController, "RemoveLogsOlderThan"); optValue.has_value()) {
+                    // FlushInterval (milliseconds)
+                    if (auto optValue = contains(mapController, "FlushInterval"); optValue.has_value()) {
+                        if (int castedValue = std::any_cast<int>(optValue); castedValue > 0) {
+                            config.flushInterval = std::chrono::milliseconds(castedValue);
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
+                    }
+
+                    // FlushBytes
+                    if (auto optValue = contains(mapController, "FlushBytes"); optValue.has_value()) {
                         std::string castedValue = std::any_cast<std::string>(optValue);
 
-                        if (auto value = parseRemoveLogsOlderThan(castedValue); value != 0) {
-                            config.removeLogsOlderThan = value;
+                        if (auto result = filesize_t::parseFileSize(castedValue); result.has_value()) {
+                            config.flushBytes = result.value();
                         } else {
                             std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
                         }
                     }
 
-                    // LogLevel
-                    if (auto optValue = contains(mapController, "LogLevel"); optValue.has_value()) {
+                    // Compression
+                    if (auto optValue = contains(mapController, "Compression"); optValue.has_value()) {
                         std::string castedValue = std::any_cast<std::string>(optValue);
 
-                        if (auto result = parseLogLevel(castedValue)) {
-                            config.logLevel = result.value();
+                        if (auto result = parseCompression(castedValue); result.has_value()) {
+                            config.compression = result.value();
                         } else {
                             std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
                         }
                     }
 
-                    // LogMode
-                    if (auto optValue = contains(mapController, "LogMode"); optValue.has_value()) {
+                    // FileBackend
+                    if (auto optValue = contains(mapController, "FileBackend"); optValue.has_value()) {
                         std::string castedValue = std::any_cast<std::string>(optValue);
 
-                        if (auto result = parseLogMode(castedValue); result.has_value()) {
-                            config.logMode = result.value();
+                        if (auto result = parseFileBackend(castedValue); result.has_value()) {
+                            config.fileBackend = result.value();
                         } else {
                             std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
                         }
                     }
 
-                    // CheckPoint
-                    if (auto optValue = contains(mapController, "CheckPoint"); optValue.has_value()) {
+                    // SyncPolicy
+                    if (auto optValue = contains(mapController, "SyncPolicy"); optValue.has_value()) {
                         std::string castedValue = std::any_cast<std::string>(optValue);
 
-                        if (auto result = parseCheckPoint(castedValue); result.has_value()) {
-                            config.checkPoint = result.value();
+                        if (auto result = parseSyncPolicy(castedValue); result.has_value()) {
+                            config.syncPolicy = result.value();
                         } else {
                             std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
                         }
                     }
 
-                    // EnableFileWatcher
-                    if (auto optValue = contains(mapController, "EnableFileWatcher"); optValue.has_value()) {
-                        config.enableFileWatcher = std::any_cast<bool>(optValue);
+                    // SyncInterval (milliseconds)
+                    if (auto optValue = contains(mapController, "SyncInterval"); optValue.has_value()) {
+                        if (int castedValue = std::any_cast<int>(optValue); castedValue > 0) {
+                            config.syncInterval = std::chrono::milliseconds(castedValue);
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
                     }
 
-                    // EnableAutoRemove
-                    if (auto optValue = contains(mapController, "EnableAutoRemove"); optValue.has_value()) {
-                        config.enableAutoRemove = std::any_cast<bool>(optValue);
+                    // EnableLatencyStatistics
+                    if (auto optValue = contains(mapController, "EnableLatencyStatistics"); optValue.has_value()) {
+                        config.enableLatencyStatistics = std::any_cast<bool>(optValue);
+                    }
+
+                    // LatencyReportInterval (milliseconds)
+                    if (auto optValue = contains(mapController, "LatencyReportInterval"); optValue.has_value()) {
+                        if (int castedValue = std::any_cast<int>(optValue); castedValue >= 0) {
+                            config.latencyReportInterval = std::chrono::milliseconds(castedValue);
+                        } else {
+                            std::cerr << "logcplus: Unexpected configuration option: " << castedValue << std::endl;
+                        }
                     }
                 } catch (std::bad_any_cast& _ex) {
                     std::cerr << "logcplus: Unexpected error when parsing configuration file, message: " << _ex.what() << std::endl;
@@ -1540,7 +6378,8 @@ namespace dev::marcinromanowski::logcplus {
                 }
             }
 
-            return std::nullopt;
+            // Empty (std::any holding std::nullopt has a value).
+            return {};
         }
 
         static std::optional<filesize_t> parseMaxLogFileSize(const std::string _value) {
@@ -1626,6 +6465,134 @@ namespace dev::marcinromanowski::logcplus {
             return std::nullopt;
         }
 
+        static std::optional<Logger::FormattingMode> parseFormattingMode(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("eager") == 0) {
+                return Logger::FormattingMode::Eager;
+            }
+            if (_value.compare("deferred") == 0) {
+                return Logger::FormattingMode::Deferred;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<TimestampCache::Precision> parseTimestampPrecision(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("seconds") == 0) {
+                return TimestampCache::Precision::Seconds;
+            }
+            if (_value.compare("milliseconds") == 0) {
+                return TimestampCache::Precision::Milliseconds;
+            }
+            if (_value.compare("microseconds") == 0) {
+                return TimestampCache::Precision::Microseconds;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<Logger::QueueType> parseQueueType(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("locked") == 0) {
+                return Logger::QueueType::Locked;
+            }
+            if (_value.compare("lockfree") == 0) {
+                return Logger::QueueType::LockFree;
+            }
+            if (_value.compare("perthread") == 0) {
+                return Logger::QueueType::PerThread;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<Logger::OverflowPolicy> parseOverflowPolicy(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("block") == 0) {
+                return Logger::OverflowPolicy::Block;
+            }
+            if (_value.compare("dropnewest") == 0) {
+                return Logger::OverflowPolicy::DropNewest;
+            }
+            if (_value.compare("dropoldest") == 0) {
+                return Logger::OverflowPolicy::DropOldest;
+            }
+            if (_value.compare("dropbelowlevel") == 0) {
+                return Logger::OverflowPolicy::DropBelowLevel;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<Logger::FileBackend> parseFileBackend(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("write") == 0) {
+                return Logger::FileBackend::Write;
+            }
+            if (_value.compare("mmap") == 0) {
+                return Logger::FileBackend::Mmap;
+            }
+            if (_value.compare("iouring") == 0) {
+                return Logger::FileBackend::IoUring;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<Logger::SyncPolicy> parseSyncPolicy(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("none") == 0) {
+                return Logger::SyncPolicy::None;
+            }
+            if (_value.compare("periodic") == 0) {
+                return Logger::SyncPolicy::Periodic;
+            }
+            if (_value.compare("onerror") == 0) {
+                return Logger::SyncPolicy::OnError;
+            }
+            if (_value.compare("everybatch") == 0) {
+                return Logger::SyncPolicy::EveryBatch;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<Logger::Compression> parseCompression(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("none") == 0) {
+                return Logger::Compression::None;
+            }
+            if (_value.compare("gzip") == 0) {
+                return Logger::Compression::Gzip;
+            }
+
+            return std::nullopt;
+        }
+
+        static std::optional<Logger::FlushPolicy> parseFlushPolicy(std::string _value) {
+            std::transform(_value.begin(), _value.end(), _value.begin(), ::tolower);
+
+            if (_value.compare("everybatch") == 0) {
+                return Logger::FlushPolicy::EveryBatch;
+            }
+            if (_value.compare("interval") == 0) {
+                return Logger::FlushPolicy::Interval;
+            }
+            if (_value.compare("bytes") == 0) {
+                return Logger::FlushPolicy::Bytes;
+            }
+
+            return std::nullopt;
+        }
+
         static std::optional<Date::Time> parseCheckPoint(std::string _value) {
             std::replace(_value.begin(), _value.end(), ':', ' ');  // replace ':' by ' '.
 
@@ -1676,6 +6643,23 @@ namespace dev::marcinromanowski::logcplus {
             return Logger::instance();
         }
 
+        /**
+         * @brief Registers additional log sink (e.g. separate file for errors). Messages are filtered by the logger level
+         * first and then by the sink level.
+         * @param _sink Log sink.
+         */
+        void addSink(std::shared_ptr<LogSink> _sink) {
+            Logger::instance()->addSink(std::move(_sink));
+        }
+
+        /**
+         * @brief Unregisters additional log sink.
+         * @param _sink Log sink.
+         */
+        void removeSink(const std::shared_ptr<LogSink>& _sink) {
+            Logger::instance()->removeSink(_sink);
+        }
+
         void setLogLevel(const Logger::LogLevel _logLevel) {
             configuration_.logLevel = _logLevel;
         }
@@ -1684,6 +6668,22 @@ namespace dev::marcinromanowski::logcplus {
             configuration_.logMode = _logMode;
         }
 
+        /**
+         * @brief Selects where log messages are formatted (caller thread or queue worker thread).
+         * @param _formattingMode Formatting mode.
+         */
+        void setFormattingMode(const Logger::FormattingMode _formattingMode) {
+            configuration_.formattingMode = _formattingMode;
+        }
+
+        /**
+         * @brief Sets log timestamp precision.
+         * @param _timestampPrecision Seconds, milliseconds or microseconds.
+         */
+        void setTimestampPrecision(const TimestampCache::Precision _timestampPrecision) {
+            configuration_.timestampPrecision = _timestampPrecision;
+        }
+
         void setLogDirectory(const std::filesystem::path& _logDirectory) {
             configuration_.logDirectoryPath = _logDirectory;
         }
@@ -1692,6 +6692,131 @@ namespace dev::marcinromanowski::logcplus {
             configuration_.removeLogsOlderThan = _days;
         }
 
+        /**
+         * @brief Selects the message queue implementation. The queue is replaced by `initialize` only if the logger is
+         * not running (see `shutdown`).
+         * @param _queueType Queue implementation.
+         * @param _queueCapacity Max number of pending messages (per thread for PerThread queue), 0 - unbounded locked
+         * queue or default capacity of the lock-free queues.
+         */
+        void setQueueType(const Logger::QueueType _queueType, const std::size_t _queueCapacity = 0) {
+            configuration_.queueType = _queueType;
+            configuration_.queueCapacity = _queueCapacity;
+        }
+
+        /**
+         * @brief Keeps a copy of queued messages in the shared memory ring (/dev/shm), so messages not written before
+         * the process death can be recovered with the logcplusRecover tool.
+         * @param _enabled Shared memory ring is used.
+         * @param _size Ring size.
+         */
+        void setSharedMemoryRing(const bool _enabled, const filesize_t _size = filesize_t(16, filesize_t::SizeUnit::MiB)) {
+            configuration_.enableSharedMemoryRing = _enabled;
+            configuration_.sharedMemoryRingSize = _size;
+        }
+
+        /**
+         * @brief Sets the number of recent messages below the log level kept in memory and written before the next
+         * Error or Fatal message (or on `Logger::dumpBacktrace` request).
+         * @param _backtraceSize Number of messages, 0 - disabled.
+         */
+        void setBacktraceSize(const std::size_t _backtraceSize) {
+            configuration_.backtraceSize = _backtraceSize;
+        }
+
+        /**
+         * @brief Sets max number of pending messages (see `setQueueType`).
+         */
+        void setQueueCapacity(const std::size_t _queueCapacity) {
+            configuration_.queueCapacity = _queueCapacity;
+        }
+
+        /**
+         * @brief Sets what to do with a new message when the bounded queue is full.
+         * @param _overflowPolicy Overflow policy.
+         * @param _overflowLevel Messages below this level are dropped by OverflowPolicy::DropBelowLevel.
+         */
+        void setOverflowPolicy(const Logger::OverflowPolicy _overflowPolicy, const Logger::LogLevel _overflowLevel = Logger::LogLevel::Error) {
+            configuration_.overflowPolicy = _overflowPolicy;
+            configuration_.overflowLevel = _overflowLevel;
+        }
+
+        /**
+         * @brief Sets when the coalesced messages are flushed to the output.
+         * @param _flushPolicy Flush policy.
+         */
+        void setFlushPolicy(const Logger::FlushPolicy _flushPolicy) {
+            configuration_.flushPolicy = _flushPolicy;
+        }
+
+        void setFlushInterval(const std::chrono::milliseconds _flushInterval) {
+            configuration_.flushInterval = _flushInterval;
+        }
+
+        void setFlushBytes(const filesize_t _flushBytes) {
+            configuration_.flushBytes = _flushBytes;
+        }
+
+        /**
+         * @brief Sets compression of the rotated log files.
+         * @param _compression Compression.
+         */
+        void setCompression(const Logger::Compression _compression) {
+            configuration_.compression = _compression;
+        }
+
+        /**
+         * @brief Sets how the log file is written (write(2) or memory mapped segments of the max log file size).
+         * @param _fileBackend File backend.
+         */
+        void setFileBackend(const Logger::FileBackend _fileBackend) {
+            configuration_.fileBackend = _fileBackend;
+        }
+
+        /**
+         * @brief Sets when the written messages are synced to the disk (fdatasync).
+         * @param _syncPolicy Sync policy.
+         */
+        void setSyncPolicy(const Logger::SyncPolicy _syncPolicy) {
+            configuration_.syncPolicy = _syncPolicy;
+        }
+
+        void setSyncInterval(const std::chrono::milliseconds _syncInterval) {
+            configuration_.syncInterval = _syncInterval;
+        }
+
+        /**
+         * @brief Enables the queue wait, format, write and end to end latency histograms (see latencyStatistics).
+         */
+        void setLatencyStatistics(const bool _enabled) {
+            configuration_.enableLatencyStatistics = _enabled;
+        }
+
+        /**
+         * @brief Sets the interval of the latency log message (percentiles since the previous report, 0 - not reported).
+         */
+        void setLatencyReportInterval(const std::chrono::milliseconds _latencyReportInterval) {
+            configuration_.latencyReportInterval = _latencyReportInterval;
+        }
+
+        /**
+         * @brief Latency of the records written since the logger was started (see Logger::LatencyStatistics).
+         */
+        Logger::LatencyStatistics latencyStatistics() const {
+            return Logger::instance()->latencyStatistics();
+        }
+
+        /**
+         * @brief Logging pipeline counters (see Logger::Statistics). Counters are sharded per thread, so reading them
+         * never slows down the logging threads.
+         */
+        Logger::Statistics statistics() const {
+            Logger::Statistics statistics = Logger::instance()->statistics();
+            statistics.removedFiles = directoryWatcher_->removedFiles();
+
+            return statistics;
+        }
+
         void setMaxFileSize(const filesize_t _fileSize) {
             configuration_.maxLogFileSize = _fileSize;
         }
@@ -1715,20 +6840,32 @@ namespace dev::marcinromanowski::logcplus {
             // Set log level and log mode.
             Logger::instance()->logMode_ = configuration_.logMode;
             Logger::instance()->logLevel_ = configuration_.logLevel;
+            Logger::instance()->formattingMode_ = configuration_.formattingMode;
+            Logger::instance()->timestampPrecision_.store(configuration_.timestampPrecision, std::memory_order_relaxed);
+            Logger::instance()->defaultFormatter_.setPrecision(configuration_.timestampPrecision);
+            Logger::instance()->setQueueType(configuration_.queueType, configuration_.queueCapacity);
+            Logger::instance()->setSharedMemoryRing(configuration_.enableSharedMemoryRing, configuration_.sharedMemoryRingSize.bsize());
+            Logger::instance()->setOverflowPolicy(configuration_.overflowPolicy, configuration_.overflowLevel);
+            Logger::instance()->setFlushPolicy(configuration_.flushPolicy, configuration_.flushInterval, configuration_.flushBytes.bsize());
+            Logger::instance()->setMaxFileSize(configuration_.maxLogFileSize.bsize());
+            Logger::instance()->setCompression(configuration_.compression);
+            Logger::instance()->setFileBackend(configuration_.fileBackend);
+            Logger::instance()->setSyncPolicy(configuration_.syncPolicy, configuration_.syncInterval);
+            Logger::instance()->setBacktraceSize(configuration_.backtraceSize);
+            Logger::instance()->setLatencyStatistics(configuration_.enableLatencyStatistics, configuration_.latencyReportInterval);
 
             // Reopen log file.
             if (configuration_.logMode == Logger::LogMode::File) {
                 Logger::instance()->reopen(configuration_.logDirectoryPath);
                 // or just initialize when we need log on the console output (start message queue processing).
             } else {
+                Logger::instance()->closeHandlers();
                 Logger::instance()->initialize();
             }
 
             // Enable extensions.
             if (configuration_.enableFileWatcher) {
                 FileWatcher::FileWatcherSettings* settings = fileWatcher_->settings();
-                settings->filePath = getLogger()->currentFile();
-                settings->maxFileSize = configuration_.maxLogFileSize;
                 settings->checkPoint = configuration_.checkPoint;
 
                 enableFileWatcher();
@@ -1737,13 +6874,42 @@ namespace dev::marcinromanowski::logcplus {
             if (configuration_.enableAutoRemove) {
                 enableDirectoryWatcher();
             }
+
+            if (configuration_.enableCrashHandler) {
+                enableCrashHandler();
+            }
+        }
+
+        /**
+         * @brief Installs the fatal signals handler (SIGSEGV, SIGABRT, SIGBUS, SIGFPE) which writes all pending messages
+         * and the Fatal line before the process terminates.
+         */
+        void enableCrashHandler() {
+            Logger::instance()->setCrashHandler(true);
+        }
+
+        /**
+         * @brief Restores the previous fatal signal handlers.
+         */
+        void disableCrashHandler() {
+            Logger::instance()->setCrashHandler(false);
+        }
+
+        /**
+         * @brief Stops the logger: pending messages are written, log file is closed and watchers are stopped. Logger is
+         * started again by `initialize`.
+         */
+        void shutdown() {
+            fileWatcher_->stop();
+            directoryWatcher_->stop();
+            Logger::instance()->stop();
         }
 
         /**
-         * @brief Enables file watcher (checkpoints and file size limit).
+         * @brief Enables file watcher (checkpoints, the file size limit is checked by the logger on every write).
          */
         void enableFileWatcher() {
-            if (fileWatcher_ && configuration_.enableFileWatcher && configuration_.logMode == Logger::LogMode::File) {
+            if (fileWatcher_ && configuration_.enableFileWatcher && configuration_.checkPoint && configuration_.logMode == Logger::LogMode::File) {
                 fileWatcher_->start([=] {
                     Logger::instance()->reopen(configuration_.logDirectoryPath);
                 });
@@ -1751,7 +6917,7 @@ namespace dev::marcinromanowski::logcplus {
         }
 
         /**
-         * @brief Disables file watcher (checkpoints and file size limit).
+         * @brief Disables file watcher (checkpoints).
          */
         void disableFileWatcher() {
             fileWatcher_->stop();
@@ -1796,4 +6962,46 @@ namespace dev::marcinromanowski::logcplus {
     };
 }
 
+/*
+ * Lazy logging macros. Arguments are evaluated only when the message will be printed (or kept in the backtrace
+ * buffer), calls below LOGCPLUS_ACTIVE_LEVEL are removed by the preprocessor.
+ *
+ * Usage: LOGCPLUS_DEBUG(logger, "Value:", expensiveCall());
+ */
+#define LOGCPLUS_LOG(_logger, _logLevel, ...) \
+    do { \
+        auto* logcplusLogger = (_logger); \
+        if (logcplusLogger->isEnabled(_logLevel)) { \
+            logcplusLogger->log(_logLevel, __VA_ARGS__); \
+        } else if (logcplusLogger->isBacktraced(_logLevel)) { \
+            logcplusLogger->backtrace(_logLevel, __VA_ARGS__); \
+        } \
+    } while (false)
+
+#if LOGCPLUS_ACTIVE_LEVEL <= 0
+#define LOGCPLUS_DEBUG(_logger, ...) LOGCPLUS_LOG(_logger, ::dev::marcinromanowski::logcplus::LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOGCPLUS_DEBUG(_logger, ...) static_cast<void>(0)
+#endif
+
+#if LOGCPLUS_ACTIVE_LEVEL <= 1
+#define LOGCPLUS_INFO(_logger, ...) LOGCPLUS_LOG(_logger, ::dev::marcinromanowski::logcplus::LogLevel::Info, __VA_ARGS__)
+#else
+#define LOGCPLUS_INFO(_logger, ...) static_cast<void>(0)
+#endif
+
+#if LOGCPLUS_ACTIVE_LEVEL <= 2
+#define LOGCPLUS_WARN(_logger, ...) LOGCPLUS_LOG(_logger, ::dev::marcinromanowski::logcplus::LogLevel::Warn, __VA_ARGS__)
+#else
+#define LOGCPLUS_WARN(_logger, ...) static_cast<void>(0)
+#endif
+
+#if LOGCPLUS_ACTIVE_LEVEL <= 3
+#define LOGCPLUS_ERROR(_logger, ...) LOGCPLUS_LOG(_logger, ::dev::marcinromanowski::logcplus::LogLevel::Error, __VA_ARGS__)
+#else
+#define LOGCPLUS_ERROR(_logger, ...) static_cast<void>(0)
+#endif
+
+#define LOGCPLUS_FATAL(_logger, ...) LOGCPLUS_LOG(_logger, ::dev::marcinromanowski::logcplus::LogLevel::Fatal, __VA_ARGS__)
+
 #endif //LOGCPLUS_LOGCPLUS_H
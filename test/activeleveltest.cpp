@@ -0,0 +1,108 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE LOGCPLUS_ACTIVE_LEVEL_TESTS
+
+// Calls below Warn are stripped at compile time (see LOGCPLUS_ACTIVE_LEVEL).
+#define LOGCPLUS_ACTIVE_LEVEL 2
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <thread>
+
+#include "predefinedpollingconditions.h"
+#include "testsfixture.h"
+#include "logcplus.h"
+
+namespace dev::marcinromanowski {
+
+    inline static logcplus::LogManager* LOG_MANAGER = logcplus::LogManager::instance();
+
+    BOOST_AUTO_TEST_CASE(callsBelowActiveLevelShouldNotBeWrittenNorEvaluateArguments)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("callsBelowActiveLevelShouldNotBeWritten");
+
+        // given
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        // Runtime level enables everything, only the compile time level filters.
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        LOG_MANAGER->initialize();
+
+        int evaluations = 0;
+        auto countedArgument = [&evaluations]() -> int {
+            return ++evaluations;
+        };
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        LOGCPLUS_DEBUG(logger, "Debug macro", countedArgument());
+        LOGCPLUS_INFO(logger, "Info macro", countedArgument());
+        LOGCPLUS_WARN(logger, "Warn macro", countedArgument());
+        LOGCPLUS_ERROR(logger, "Error macro", countedArgument());
+        LOGCPLUS_FATAL(logger, "Fatal macro", countedArgument());
+        logger->debug("Debug method");
+        logger->info("Info method");
+        logger->warn("Warn method");
+
+        // then
+        std::vector<std::string> logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getLogsFromFile("callsBelowActiveLevelShouldNotBeWritten");
+            return logs.size() >= 4;
+        }));
+
+        // Give the stripped calls a chance to show up (they must not).
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        logs = getLogsFromFile("callsBelowActiveLevelShouldNotBeWritten");
+        delete coutHandler;
+
+        static_assert(!logcplus::Logger::isActive(logcplus::Logger::LogLevel::Info));
+        static_assert(logcplus::Logger::isActive(logcplus::Logger::LogLevel::Warn));
+        BOOST_CHECK_EQUAL(evaluations, 3);
+        BOOST_REQUIRE_EQUAL(logs.size(), 4);
+        BOOST_CHECK(logs[0].rfind("[WARN] ", 0) == 0 && logs[0].find(" - Warn macro 1") != std::string::npos);
+        BOOST_CHECK(logs[1].rfind("[ERROR] ", 0) == 0 && logs[1].find(" - Error macro 2") != std::string::npos);
+        BOOST_CHECK(logs[2].rfind("[FATAL] ", 0) == 0 && logs[2].find(" - Fatal macro 3") != std::string::npos);
+        BOOST_CHECK(logs[3].rfind("[WARN] ", 0) == 0 && logs[3].find(" - Warn method") != std::string::npos);
+    }
+
+    // Arguments referenced only by the log calls below, the functions are emitted only if the call is compiled.
+    __attribute__((noinline)) inline int strippedDebugArgument() {
+        return 0;
+    }
+
+    __attribute__((noinline)) inline int strippedInfoArgument() {
+        return 1;
+    }
+
+    __attribute__((noinline)) inline int activeWarnArgument() {
+        return 2;
+    }
+
+    BOOST_AUTO_TEST_CASE(callsBelowActiveLevelShouldNotBeCompiledIntoExecutable)
+    {
+        // given
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Fatal);
+        LOG_MANAGER->initialize();
+        auto logger = logcplus::LogManager::getLogger();
+        LOGCPLUS_DEBUG(logger, strippedDebugArgument());
+        LOGCPLUS_INFO(logger, strippedInfoArgument());
+        LOGCPLUS_WARN(logger, activeWarnArgument());
+
+        // Names are searched reversed, so the searched text itself isn't in the executable.
+        auto symbol = [](std::string _reversed) {
+            std::reverse(_reversed.begin(), _reversed.end());
+            return _reversed;
+        };
+
+        // when
+        std::ifstream executable("/proc/self/exe", std::ios::binary);
+        std::string content(std::istreambuf_iterator<char>(executable), {});
+
+        // then
+        BOOST_REQUIRE(!content.empty());
+        BOOST_CHECK(content.find(symbol("tnemugrAgubeDdeppirts")) == std::string::npos);
+        BOOST_CHECK(content.find(symbol("tnemugrAofnIdeppirts")) == std::string::npos);
+        BOOST_CHECK(content.find(symbol("tnemugrAnraWevitca")) != std::string::npos);
+    }
+}
@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Replacement of all global allocation functions (plain, array, nothrow and aligned) counting the heap allocations, the
+ * counter is declared in testsfixture.h. Kept in its own translation unit, so the compiler doesn't pair the inlined
+ * malloc / free with new / delete expressions.
+ */
+thread_local bool COUNT_ALLOCATIONS = false;
+thread_local std::size_t ALLOCATIONS = 0;
+
+namespace {
+
+    void* allocate(const std::size_t _size, const std::size_t _alignment) noexcept {
+        if (COUNT_ALLOCATIONS) {
+            ALLOCATIONS++;
+        }
+
+        std::size_t size = _size == 0 ? 1 : _size;
+        if (_alignment <= alignof(std::max_align_t)) {
+            return std::malloc(size);
+        }
+
+        // Size of the aligned allocation must be a multiple of the alignment.
+        return std::aligned_alloc(_alignment, (size + _alignment - 1) & ~(_alignment - 1));
+    }
+
+    void* allocateOrThrow(const std::size_t _size, const std::size_t _alignment) {
+        if (void* memory = allocate(_size, _alignment)) {
+            return memory;
+        }
+
+        throw std::bad_alloc();
+    }
+
+}
+
+void* operator new(std::size_t _size) {
+    return allocateOrThrow(_size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t _size) {
+    return allocateOrThrow(_size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t _size, const std::nothrow_t&) noexcept {
+    return allocate(_size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t _size, const std::nothrow_t&) noexcept {
+    return allocate(_size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t _size, std::align_val_t _alignment) {
+    return allocateOrThrow(_size, static_cast<std::size_t>(_alignment));
+}
+
+void* operator new[](std::size_t _size, std::align_val_t _alignment) {
+    return allocateOrThrow(_size, static_cast<std::size_t>(_alignment));
+}
+
+void* operator new(std::size_t _size, std::align_val_t _alignment, const std::nothrow_t&) noexcept {
+    return allocate(_size, static_cast<std::size_t>(_alignment));
+}
+
+void* operator new[](std::size_t _size, std::align_val_t _alignment, const std::nothrow_t&) noexcept {
+    return allocate(_size, static_cast<std::size_t>(_alignment));
+}
+
+void operator delete(void* _memory) noexcept {
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory) noexcept {
+    std::free(_memory);
+}
+
+void operator delete(void* _memory, std::size_t) noexcept {
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory, std::size_t) noexcept {
+    std::free(_memory);
+}
+
+void operator delete(void* _memory, const std::nothrow_t&) noexcept {
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory, const std::nothrow_t&) noexcept {
+    std::free(_memory);
+}
+
+void operator delete(void* _memory, std::align_val_t) noexcept {
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory, std::align_val_t) noexcept {
+    std::free(_memory);
+}
+
+void operator delete(void* _memory, std::size_t, std::align_val_t) noexcept {
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory, std::size_t, std::align_val_t) noexcept {
+    std::free(_memory);
+}
+
+void operator delete(void* _memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(_memory);
+}
+
+void operator delete[](void* _memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(_memory);
+}
@@ -3,6 +3,13 @@
 
 #include <boost/test/unit_test.hpp>
 #include <regex>
+#include <thread>
+#include <iomanip>
+#include <sstream>
+#include <csignal>
+#include <set>
+#include <numeric>
+#include <sys/wait.h>
 
 #include "predefinedpollingconditions.h"
 #include "testsfixture.h"
@@ -12,6 +19,50 @@ namespace dev::marcinromanowski {
 
     inline static logcplus::LogManager* LOG_MANAGER = logcplus::LogManager::instance();
 
+    /*
+     * "Overflow log <number>" messages written per level and messages dropped per level (reported by the queue worker)
+     * in the redirected output of the overflow policy tests.
+     */
+    struct OverflowLogs {
+        std::array<std::uint64_t, 5> written{};
+        std::array<std::uint64_t, 5> dropped{};
+        std::vector<std::size_t> numbers; // Numbers of the written messages.
+
+        std::uint64_t total() const {
+            return std::accumulate(written.begin(), written.end(), std::uint64_t(0)) +
+                   std::accumulate(dropped.begin(), dropped.end(), std::uint64_t(0));
+        }
+    };
+
+    OverflowLogs getOverflowLogsFromFile(const std::string& testFilename) {
+        static const std::regex droppedRegex(R"(.*dropped \d+ messages \(DEBUG: (\d+) INFO: (\d+) WARN: (\d+) ERROR: (\d+) FATAL: (\d+) \).*)");
+        static const std::regex messageRegex(R"(^\[(DEBUG|INFO|WARN|ERROR|FATAL)\] .* - Overflow log (\d+)$)");
+        static const std::array<std::string, 5> levels = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+        OverflowLogs logs;
+        for (const auto& line: getLogsFromFile(testFilename)) {
+            std::smatch match;
+            if (std::regex_match(line, match, droppedRegex)) {
+                for (std::size_t level = 0; level < logs.dropped.size(); level++) {
+                    logs.dropped[level] += std::stoull(match[level + 1].str());
+                }
+            } else if (std::regex_match(line, match, messageRegex)) {
+                logs.written[std::find(levels.begin(), levels.end(), match[1].str()) - levels.begin()]++;
+                logs.numbers.push_back(std::stoull(match[2].str()));
+            }
+        }
+
+        return logs;
+    }
+
+    // Recursion without the end (the depth is volatile, so the call is not optimized into a loop).
+    __attribute__((noinline)) std::size_t overflowStack(const std::size_t _depth) {
+        volatile char frame[1024];
+        frame[_depth % sizeof(frame)] = static_cast<char>(_depth);
+        volatile std::size_t limit = std::numeric_limits<std::size_t>::max();
+        return _depth < limit ? overflowStack(_depth + 1) + frame[_depth % sizeof(frame)] : 0;
+    }
+
     BOOST_AUTO_TEST_CASE(logHeaderWithLogLevelAndDateShouldBeIncludedToOutput)
     {
         // setup
@@ -39,4 +90,2117 @@ namespace dev::marcinromanowski {
         BOOST_CHECK(std::regex_match(logs[0], logRegex));
     }
 
+    BOOST_AUTO_TEST_CASE(ringBufferShouldDeliverAllMessagesFromManyProducersInOrder)
+    {
+        // given
+        constexpr std::uint64_t producersCount = 8;
+        constexpr std::uint64_t messagesPerProducer = 20000;
+        logcplus::RingBuffer<std::uint64_t> ringBuffer(1000);
+        BOOST_CHECK_EQUAL(ringBuffer.capacity(), 1024);
+
+        // when
+        std::vector<std::thread> producers;
+        for (std::uint64_t producer = 0; producer < producersCount; producer++) {
+            producers.emplace_back([&ringBuffer, producer]() {
+                for (std::uint64_t message = 0; message < messagesPerProducer; message++) {
+                    ringBuffer.enqueue(producer * messagesPerProducer + message);
+                }
+            });
+        }
+
+        std::vector<std::uint64_t> lastMessages(producersCount, 0);
+        std::uint64_t received = 0;
+        bool ordered = true;
+        while (received < producersCount * messagesPerProducer) {
+            std::uint64_t message;
+            if (ringBuffer.tryDequeue(message)) {
+                std::uint64_t producer = message / messagesPerProducer;
+                ordered &= lastMessages[producer] <= message;
+                lastMessages[producer] = message;
+                received++;
+            }
+        }
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        // then
+        BOOST_CHECK(ordered);
+        BOOST_CHECK(ringBuffer.empty());
+        for (std::uint64_t producer = 0; producer < producersCount; producer++) {
+            BOOST_CHECK_EQUAL(lastMessages[producer], (producer + 1) * messagesPerProducer - 1);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(queueWorkerShouldWriteMessagesWithoutPollingDelay)
+    {
+        // setup
+        LineTimestampBuffer timestampBuffer;
+        std::streambuf* coutBuffer = std::cout.rdbuf(&timestampBuffer);
+
+        // given
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->initialize();
+        auto logger = logcplus::LogManager::getLogger();
+
+        // when (idle - the worker is parked before every message)
+        std::vector<std::chrono::microseconds> idleLatencies;
+        for (std::size_t i = 0; i < 20; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            auto enqueueTime = std::chrono::steady_clock::now();
+            logger->info("Idle log", i);
+
+            BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&timestampBuffer, i]() -> bool {
+                return timestampBuffer.lines() > i;
+            }));
+            idleLatencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(timestampBuffer.lineTimestamp(i) - enqueueTime));
+        }
+
+        // when (burst)
+        constexpr std::size_t burstSize = 1000;
+        std::vector<std::chrono::steady_clock::time_point> enqueueTimes;
+        for (std::size_t i = 0; i < burstSize; i++) {
+            enqueueTimes.push_back(std::chrono::steady_clock::now());
+            logger->info("Burst log", i);
+        }
+
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&timestampBuffer, &idleLatencies]() -> bool {
+            return timestampBuffer.lines() == idleLatencies.size() + burstSize;
+        }));
+
+        std::vector<std::chrono::microseconds> burstLatencies;
+        for (std::size_t i = 0; i < burstSize; i++) {
+            burstLatencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                timestampBuffer.lineTimestamp(idleLatencies.size() + i) - enqueueTimes[i]));
+        }
+
+        std::cout.rdbuf(coutBuffer);
+
+        // then
+        BOOST_TEST_MESSAGE("Idle enqueue-to-write latency p50: " << percentile(idleLatencies, 50).count() << "us, p99: "
+                           << percentile(idleLatencies, 99).count() << "us");
+        BOOST_TEST_MESSAGE("Burst enqueue-to-write latency p50: " << percentile(burstLatencies, 50).count() << "us, p99: "
+                           << percentile(burstLatencies, 99).count() << "us");
+        BOOST_CHECK(percentile(idleLatencies, 99) < std::chrono::milliseconds(100));
+        BOOST_CHECK(percentile(burstLatencies, 99) < std::chrono::milliseconds(500));
+    }
+
+    BOOST_AUTO_TEST_CASE(concurrentQueueShouldDrainPendingMessagesInBatches)
+    {
+        // given
+        logcplus::ConcurrentQueue<int> queue;
+        for (int i = 0; i < 10; i++) {
+            queue.enqueue(i);
+        }
+
+        // when
+        std::vector<int> firstBatch, secondBatch;
+        std::size_t firstCount = queue.tryDequeueBulk(firstBatch, 4);
+        std::size_t secondCount = queue.tryDequeueBulk(secondBatch, 100);
+
+        // then
+        BOOST_CHECK_EQUAL(firstCount, 4);
+        BOOST_CHECK_EQUAL(secondCount, 6);
+        BOOST_CHECK(queue.empty());
+        BOOST_CHECK((firstBatch == std::vector<int>{0, 1, 2, 3}));
+        BOOST_CHECK((secondBatch == std::vector<int>{4, 5, 6, 7, 8, 9}));
+    }
+
+    BOOST_AUTO_TEST_CASE(packedLogArgumentsShouldBeFormattedLikeEagerArguments)
+    {
+        // given
+        std::string packedArguments;
+        std::string text = "text";
+        std::string_view view = "view";
+
+        // when
+        logcplus::LogArguments::pack(packedArguments, "Test log", 42, -7L, 3.5, 2.25f, 10u, text, view, 'a', true);
+        std::string formattedArguments;
+        logcplus::LogArguments::format(packedArguments, formattedArguments);
+
+        // then
+        BOOST_CHECK_EQUAL(formattedArguments, " Test log 42 -7 3.500000 2.250000 10 text view 97 1");
+    }
+
+    BOOST_AUTO_TEST_CASE(deferredLogShouldBeFormattedByQueueWorker)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("deferredLogShouldBeFormattedByQueueWorker");
+
+        // given
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Deferred);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        logger->warn("Deferred log", 1, 2.5);
+
+        // then
+        std::vector<std::string> logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getLogsFromFile("deferredLogShouldBeFormattedByQueueWorker");
+            return logs.size() == 1;
+        }));
+
+        delete coutHandler;
+        LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Eager);
+        auto logRegex = std::regex(R"(^\[WARN\] \d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2} - Deferred log 1 2.500000$)");
+        BOOST_CHECK(std::regex_match(logs[0], logRegex));
+    }
+
+    BOOST_AUTO_TEST_CASE(timestampCacheShouldRenderSameTimestampAsPutTime)
+    {
+        // given
+        logcplus::TimestampCache secondsCache;
+        logcplus::TimestampCache millisecondsCache(logcplus::TimestampCache::Precision::Milliseconds);
+        logcplus::TimestampCache microsecondsCache(logcplus::TimestampCache::Precision::Microseconds);
+        auto start = std::chrono::system_clock::from_time_t(1700000000);
+
+        for (long long offset: {0LL, 1234LL, 999999LL, 1000000LL, 1000001LL, 61500042LL, 86400000007LL}) {
+            // when
+            auto timePoint = start + std::chrono::microseconds(offset);
+            std::time_t time = std::chrono::system_clock::to_time_t(timePoint);
+            std::tm localTime = logcplus::Date::toLocalTime(time);
+            std::stringstream expected;
+            expected << std::put_time(&localTime, "%Y-%m-%d %X");
+
+            std::ostringstream micros;
+            micros << std::setw(6) << std::setfill('0') << offset % 1000000;
+
+            // then
+            BOOST_CHECK_EQUAL(secondsCache.format(timePoint), expected.str());
+            BOOST_CHECK_EQUAL(millisecondsCache.format(timePoint), expected.str() + "." + micros.str().substr(0, 3));
+            BOOST_CHECK_EQUAL(microsecondsCache.format(timePoint), expected.str() + "." + micros.str());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(lazyLogMacrosShouldNotEvaluateArgumentsOfDisabledLevels)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("lazyLogMacrosShouldNotEvaluateArgumentsOfDisabledLevels");
+
+        // given
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Warn);
+        LOG_MANAGER->initialize();
+
+        int evaluations = 0;
+        auto expensiveArgument = [&evaluations]() -> int {
+            return ++evaluations;
+        };
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        LOGCPLUS_DEBUG(logger, "Debug log", expensiveArgument());
+        LOGCPLUS_INFO(logger, "Info log", expensiveArgument());
+        LOGCPLUS_ERROR(logger, "Error log", expensiveArgument());
+
+        // then
+        std::vector<std::string> logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getLogsFromFile("lazyLogMacrosShouldNotEvaluateArgumentsOfDisabledLevels");
+            return logs.size() == 1;
+        }));
+
+        delete coutHandler;
+        static_assert(logcplus::Logger::isActive(logcplus::Logger::LogLevel::Fatal));
+        BOOST_CHECK_EQUAL(evaluations, 1);
+        BOOST_CHECK(logs[0].find("Error log 1") != std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE(perThreadQueueShouldMergeMessagesFromAllThreadsInOrder)
+    {
+        // given
+        constexpr std::uint64_t producersCount = 4;
+        constexpr std::uint64_t messagesPerProducer = 1000;
+        logcplus::PerThreadQueue<std::uint64_t> queue(2048);
+        std::atomic<std::uint64_t> clock{0};
+
+        // when
+        std::vector<std::thread> producers;
+        for (std::uint64_t producer = 0; producer < producersCount; producer++) {
+            producers.emplace_back([&queue, &clock]() {
+                for (std::uint64_t message = 0; message < messagesPerProducer; message++) {
+                    queue.enqueue(clock.fetch_add(1));
+                }
+            });
+        }
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        std::vector<std::uint64_t> messages;
+        while (queue.tryDequeueBulk(messages, 512) > 0) {}
+
+        // then
+        BOOST_CHECK_EQUAL(messages.size(), producersCount * messagesPerProducer);
+        BOOST_CHECK(std::is_sorted(messages.begin(), messages.end()));
+        BOOST_CHECK(queue.empty());
+    }
+
+    BOOST_AUTO_TEST_CASE(droppedMessagesShouldBeReportedByQueueWorker)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("droppedMessagesShouldBeReportedByQueueWorker");
+
+        // given
+        constexpr std::size_t messagesCount = 20000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked, 8);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::DropNewest);
+        // Queue is replaced only when the logger is not running.
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Overflow log", i);
+        }
+
+        // then (every message is either written or reported as dropped)
+        OverflowLogs logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getOverflowLogsFromFile("droppedMessagesShouldBeReportedByQueueWorker");
+            return logs.total() == messagesCount;
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        delete coutHandler;
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::Block);
+        LOG_MANAGER->initialize();
+        BOOST_TEST_MESSAGE("Written: " << logs.written[1] << ", dropped: " << logs.dropped[1]);
+        BOOST_CHECK_EQUAL(logs.total(), messagesCount);
+        BOOST_CHECK_EQUAL(logs.written[1] + logs.dropped[1], messagesCount);
+        BOOST_CHECK_EQUAL(after.dropped[1] - before.dropped[1], logs.dropped[1]);
+        BOOST_CHECK_EQUAL(after.enqueued[1] - before.enqueued[1], logs.written[1]);
+        BOOST_CHECK(std::is_sorted(logs.numbers.begin(), logs.numbers.end()));
+    }
+
+    BOOST_AUTO_TEST_CASE(blockOverflowPolicyShouldWriteAllMessages)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("blockOverflowPolicyShouldWriteAllMessages");
+
+        // given
+        constexpr std::size_t messagesCount = 20000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked, 8);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::Block);
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Overflow log", i);
+        }
+
+        // then
+        OverflowLogs logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getOverflowLogsFromFile("blockOverflowPolicyShouldWriteAllMessages");
+            return logs.total() == messagesCount;
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        delete coutHandler;
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->initialize();
+
+        BOOST_CHECK_EQUAL(logs.written[1], messagesCount);
+        BOOST_CHECK_EQUAL(logs.dropped[1], 0);
+        BOOST_CHECK_EQUAL(after.dropped[1] - before.dropped[1], 0);
+        BOOST_CHECK_EQUAL(after.enqueued[1] - before.enqueued[1], messagesCount);
+        BOOST_REQUIRE_EQUAL(logs.numbers.size(), messagesCount);
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            BOOST_REQUIRE_EQUAL(logs.numbers[i], i);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(dropOldestOverflowPolicyShouldKeepNewestMessages)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("dropOldestOverflowPolicyShouldKeepNewestMessages");
+
+        // given
+        constexpr std::size_t messagesCount = 20000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked, 8);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::DropOldest);
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Overflow log", i);
+        }
+
+        // then
+        OverflowLogs logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getOverflowLogsFromFile("dropOldestOverflowPolicyShouldKeepNewestMessages");
+            return logs.total() == messagesCount;
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        delete coutHandler;
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::Block);
+        LOG_MANAGER->initialize();
+
+        // The single producer always makes room for its message, so the newest message is never dropped.
+        BOOST_CHECK_EQUAL(logs.written[1] + logs.dropped[1], messagesCount);
+        BOOST_CHECK_EQUAL(after.dropped[1] - before.dropped[1], logs.dropped[1]);
+        BOOST_CHECK_EQUAL(after.enqueued[1] - before.enqueued[1], messagesCount);
+        BOOST_REQUIRE(!logs.numbers.empty());
+        BOOST_CHECK_EQUAL(logs.numbers.back(), messagesCount - 1);
+        BOOST_CHECK(std::is_sorted(logs.numbers.begin(), logs.numbers.end()));
+    }
+
+    BOOST_AUTO_TEST_CASE(dropOldestOverflowPolicyShouldDropNewestMessagesOfSingleConsumerQueue)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("dropOldestOverflowPolicyShouldDropNewestMessages");
+
+        // given (only the consumer can dequeue from the per thread queue)
+        constexpr std::size_t messagesCount = 20000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::PerThread, 8);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::DropOldest);
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Overflow log", i);
+        }
+
+        // then
+        OverflowLogs logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getOverflowLogsFromFile("dropOldestOverflowPolicyShouldDropNewestMessages");
+            return logs.total() == messagesCount;
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        delete coutHandler;
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::Block);
+        LOG_MANAGER->initialize();
+
+        // Dropped messages are never dequeued, so every enqueued message is written.
+        BOOST_CHECK_EQUAL(logs.written[1] + logs.dropped[1], messagesCount);
+        BOOST_CHECK_EQUAL(after.dropped[1] - before.dropped[1], logs.dropped[1]);
+        BOOST_CHECK_EQUAL(after.enqueued[1] - before.enqueued[1], logs.written[1]);
+        BOOST_CHECK(std::is_sorted(logs.numbers.begin(), logs.numbers.end()));
+    }
+
+    BOOST_AUTO_TEST_CASE(dropBelowLevelOverflowPolicyShouldKeepErrorAndFatalMessages)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("dropBelowLevelOverflowPolicyShouldKeepErrorAndFatalMessages");
+
+        // given
+        constexpr std::size_t messagesCount = 20000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked, 8);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::DropBelowLevel, logcplus::Logger::LogLevel::Error);
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when (every 10th message is Error, every 100th is Fatal)
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            if (i % 100 == 0) {
+                logger->fatal("Overflow log", i);
+            } else if (i % 10 == 0) {
+                logger->error("Overflow log", i);
+            } else if (i % 2 == 0) {
+                logger->warn("Overflow log", i);
+            } else {
+                logger->info("Overflow log", i);
+            }
+        }
+
+        // then
+        OverflowLogs logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getOverflowLogsFromFile("dropBelowLevelOverflowPolicyShouldKeepErrorAndFatalMessages");
+            return logs.total() == messagesCount;
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        delete coutHandler;
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::Block);
+        LOG_MANAGER->initialize();
+
+        std::array<std::uint64_t, 5> expected = {0, messagesCount / 2, messagesCount / 2 - messagesCount / 10,
+                                                 messagesCount / 10 - messagesCount / 100, messagesCount / 100};
+        for (std::size_t level = 0; level < expected.size(); level++) {
+            BOOST_CHECK_EQUAL(logs.written[level] + logs.dropped[level], expected[level]);
+            BOOST_CHECK_EQUAL(after.dropped[level] - before.dropped[level], logs.dropped[level]);
+            BOOST_CHECK_EQUAL(after.enqueued[level] - before.enqueued[level], logs.written[level]);
+        }
+        BOOST_CHECK_EQUAL(logs.dropped[3], 0);
+        BOOST_CHECK_EQUAL(logs.dropped[4], 0);
+        BOOST_CHECK(std::is_sorted(logs.numbers.begin(), logs.numbers.end()));
+    }
+
+    BOOST_AUTO_TEST_CASE(queueCapacityAndOverflowPolicyShouldBeLoadedFromConfigurationFile)
+    {
+        // setup
+        auto path = TEMP_DIRECTORY + directorySeparator() + "queueCapacityAndOverflowPolicy.conf";
+        auto invalidPath = TEMP_DIRECTORY + directorySeparator() + "invalidQueueCapacityAndOverflowPolicy.conf";
+
+        // given
+        std::ofstream(path) << "QueueType LockFree\nQueueCapacity 1024\nOverflowPolicy DropBelowLevel\nOverflowLevel Fatal\n";
+        std::ofstream(invalidPath) << "QueueCapacity 16\nOverflowPolicy DropEverything\n";
+
+        // when
+        auto configuration = logcplus::LoggerConfigurator::load(path);
+        auto cerrHandler = new StreamRedirection(std::cerr, TEMP_DIRECTORY + directorySeparator() + "invalidQueueCapacityAndOverflowPolicyErrors");
+        auto invalidConfiguration = logcplus::LoggerConfigurator::load(invalidPath);
+        delete cerrHandler;
+
+        // then
+        auto errors = getLogsFromFile("invalidQueueCapacityAndOverflowPolicyErrors");
+        std::filesystem::remove(path);
+        std::filesystem::remove(invalidPath);
+
+        BOOST_CHECK(configuration.queueType == logcplus::Logger::QueueType::LockFree);
+        BOOST_CHECK_EQUAL(configuration.queueCapacity, 1024);
+        BOOST_CHECK(configuration.overflowPolicy == logcplus::Logger::OverflowPolicy::DropBelowLevel);
+        BOOST_CHECK(configuration.overflowLevel == logcplus::Logger::LogLevel::Fatal);
+
+        // Invalid value is reported and the default is kept.
+        BOOST_CHECK_EQUAL(invalidConfiguration.queueCapacity, 16);
+        BOOST_CHECK(invalidConfiguration.overflowPolicy == logcplus::Logger::OverflowPolicy::Block);
+        BOOST_REQUIRE_EQUAL(errors.size(), 1);
+        BOOST_CHECK_EQUAL(errors[0], "logcplus: Unexpected configuration option: DropEverything");
+    }
+
+    BOOST_AUTO_TEST_CASE(queueShouldNotBeReplacedWhileLoggerIsRunning)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("queueShouldNotBeReplacedWhileLoggerIsRunning");
+        auto cerrHandler = new StreamRedirection(std::cerr, TEMP_DIRECTORY + directorySeparator() + "queueShouldNotBeReplacedErrors");
+
+        // given
+        constexpr std::size_t messagesCount = 1000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->initialize();
+        auto logger = logcplus::LogManager::getLogger();
+        std::atomic_bool logging = true;
+        std::thread producer([&logger, &logging]() {
+            while (logging.load()) {
+                logger->info("Running log");
+            }
+        });
+
+        // when
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::LockFree, 1024);
+        LOG_MANAGER->initialize();
+        logging.store(false);
+        producer.join();
+        std::size_t rejected = getLogsFromFile("queueShouldNotBeReplacedErrors").size();
+
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->initialize();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Lock-free log", i);
+        }
+
+        std::size_t written = 0;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&written]() -> bool {
+            auto logs = getLogsFromFile("queueShouldNotBeReplacedWhileLoggerIsRunning");
+            written = static_cast<std::size_t>(std::count_if(logs.begin(), logs.end(), [](const std::string& _log) {
+                return _log.find("Lock-free log") != std::string::npos;
+            }));
+            return written == messagesCount;
+        }));
+
+        delete coutHandler;
+        delete cerrHandler;
+        auto errors = getLogsFromFile("queueShouldNotBeReplacedErrors");
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->initialize();
+
+        // then
+        BOOST_CHECK_EQUAL(rejected, 1);
+        BOOST_REQUIRE_EQUAL(errors.size(), 1);
+        BOOST_CHECK(errors[0].find("Queue type cannot be changed while the logger is running") != std::string::npos);
+        BOOST_CHECK_EQUAL(written, messagesCount);
+    }
+
+    BOOST_AUTO_TEST_CASE(steadyStateLoggingShouldNotAllocate)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("steadyStateLoggingShouldNotAllocate");
+
+        // given
+        constexpr std::size_t rounds = 10;
+        constexpr std::size_t messagesPerRound = 200;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::LockFree, 1024);
+        LOG_MANAGER->shutdown();
+        auto logger = logcplus::LogManager::getLogger();
+        std::string text = "text";
+        std::size_t written = 0;
+
+        for (auto formattingMode: {logcplus::Logger::FormattingMode::Eager, logcplus::Logger::FormattingMode::Deferred}) {
+            LOG_MANAGER->setFormattingMode(formattingMode);
+            LOG_MANAGER->initialize();
+
+            // Warm up (thread local caches).
+            for (std::size_t round = 0; round <= rounds; round++) {
+                // when
+                COUNT_ALLOCATIONS = round > 0;
+                for (std::size_t i = 0; i < messagesPerRound; i++) {
+                    logger->info("Zero allocation log", i, 2.5, text, 'c');
+                }
+                COUNT_ALLOCATIONS = false;
+
+                written += messagesPerRound;
+                BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([written]() -> bool {
+                    return getLogsFromFile("steadyStateLoggingShouldNotAllocate").size() == written;
+                }));
+            }
+        }
+
+        delete coutHandler;
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Eager);
+        LOG_MANAGER->initialize();
+
+        // then
+        BOOST_CHECK_EQUAL(ALLOCATIONS, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(fileModeShouldWriteDirectlyToLogFileWithoutRedirectingStdOut)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "fileModeShouldWriteDirectlyToLogFile";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+        std::streambuf* coutBuffer = std::cout.rdbuf();
+
+        // given
+        constexpr std::size_t messagesCount = 1000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("File log", i);
+        }
+
+        // then
+        std::string logFile = logger->currentFile();
+        std::vector<std::string> logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs, &logFile]() -> bool {
+            std::ifstream inFile(logFile);
+            logs.clear();
+            for (std::string line; std::getline(inFile, line);) {
+                logs.push_back(line);
+            }
+
+            return logs.size() == messagesCount;
+        }));
+
+        BOOST_CHECK(std::cout.rdbuf() == coutBuffer);
+        settingsGuard.restore();
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_REQUIRE_EQUAL(logs.size(), messagesCount);
+        BOOST_CHECK(logs.front().find("File log 0") != std::string::npos);
+        BOOST_CHECK(logs.back().find("File log " + std::to_string(messagesCount - 1)) != std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE(sinksShouldReceiveMessagesAboveTheirLevelsFormattedOncePerFormatter)
+    {
+        // setup
+        class CountingFormatter : public logcplus::LogFormatter {
+        public:
+            std::atomic<std::size_t> formatted{0};
+
+            void format(const logcplus::LogRecord& _record, std::string& _output) override {
+                formatted++;
+                _output.append(logcplus::logLevelAsString(_record.level)).append(":");
+                appendMessage(_record, _output);
+            }
+        };
+
+        class MemorySink : public logcplus::LogSink {
+        public:
+            using logcplus::LogSink::LogSink;
+
+            std::vector<std::string> lines() {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::vector<std::string> result;
+                std::istringstream stream(output);
+                for (std::string line; std::getline(stream, line);) {
+                    result.push_back(line);
+                }
+
+                return result;
+            }
+
+            void write(struct iovec* _lines, std::size_t _count) override {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (std::size_t i = 0; i < _count; i++) {
+                    output.append(static_cast<const char*>(_lines[i].iov_base), _lines[i].iov_len);
+                }
+            }
+
+        private:
+            std::mutex mutex;
+            std::string output;
+        };
+
+        auto coutHandler = redirectStdOutToTemporaryFile("sinksShouldReceiveMessagesAboveTheirLevels");
+
+        // given
+        constexpr std::size_t rounds = 100;
+        auto formatter = std::make_shared<CountingFormatter>();
+        auto warnSink = std::make_shared<MemorySink>(logcplus::LogLevel::Warn, formatter);
+        auto errorSink = std::make_shared<MemorySink>(logcplus::LogLevel::Error, formatter);
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->addSink(warnSink);
+        LOG_MANAGER->addSink(errorSink);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < rounds; i++) {
+            logger->info("Info log", i);
+            logger->warn("Warn log", i);
+            logger->error("Error log", i);
+        }
+
+        // then
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            return getLogsFromFile("sinksShouldReceiveMessagesAboveTheirLevels").size() == 3 * rounds &&
+                   warnSink->lines().size() == 2 * rounds && errorSink->lines().size() == rounds;
+        }));
+
+        LOG_MANAGER->removeSink(warnSink);
+        LOG_MANAGER->removeSink(errorSink);
+        delete coutHandler;
+
+        auto warnLines = warnSink->lines();
+        auto errorLines = errorSink->lines();
+        BOOST_REQUIRE_EQUAL(warnLines.size(), 2 * rounds);
+        BOOST_REQUIRE_EQUAL(errorLines.size(), rounds);
+        BOOST_CHECK_EQUAL(warnLines[0], "WARN: Warn log 0");
+        BOOST_CHECK_EQUAL(warnLines[1], "ERROR: Error log 0");
+        BOOST_CHECK_EQUAL(errorLines[rounds - 1], "ERROR: Error log " + std::to_string(rounds - 1));
+        // Info messages are not formatted by the sink formatter, others are formatted once for both sinks.
+        BOOST_CHECK_EQUAL(formatter->formatted.load(), 2 * rounds);
+    }
+
+    BOOST_AUTO_TEST_CASE(logFileShouldBeRotatedBeforeItExceedsMaxFileSize)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "logFileShouldBeRotatedBeforeItExceedsMaxFileSize";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        // given
+        constexpr std::size_t threadsCount = 4;
+        constexpr std::size_t messagesPerThread = 5000;
+        constexpr std::uintmax_t maxFileSize = 4096;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setMaxFileSize(maxFileSize, logcplus::filesize_t::SizeUnit::B);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        std::vector<std::thread> producers;
+        for (std::size_t thread = 0; thread < threadsCount; thread++) {
+            producers.emplace_back([logger, thread]() {
+                for (std::size_t i = 0; i < messagesPerThread; i++) {
+                    logger->info("Rotated log", thread, i);
+                }
+            });
+        }
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        // then
+        std::size_t lines = 0, files = 0;
+        std::uintmax_t largestFile = 0;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            lines = files = 0;
+            largestFile = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                lines += static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>(), '\n'));
+                largestFile = std::max(largestFile, std::filesystem::file_size(file.path()));
+                files++;
+            }
+
+            return lines == threadsCount * messagesPerThread;
+        }));
+
+        settingsGuard.restore();
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_TEST_MESSAGE("Files: " << files << ", largest file: " << largestFile);
+        BOOST_CHECK_EQUAL(lines, threadsCount * messagesPerThread);
+        BOOST_CHECK_LE(largestFile, maxFileSize);
+        BOOST_CHECK_GT(files, 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(rotationUnderLoadShouldNotLoseOrDuplicateMessages)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "rotationUnderLoadShouldNotLoseOrDuplicateMessages";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        // given
+        constexpr std::size_t threadsCount = 4;
+        constexpr std::size_t messagesPerThread = 25000;
+        constexpr std::size_t reopensCount = 50;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setMaxFileSize(1, logcplus::filesize_t::SizeUnit::KiB);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        std::vector<std::thread> producers;
+        for (std::size_t thread = 0; thread < threadsCount; thread++) {
+            producers.emplace_back([logger, thread]() {
+                for (std::size_t i = 0; i < messagesPerThread; i++) {
+                    logger->info("Rotated log", thread, i);
+                }
+            });
+        }
+
+        // External reopens (e.g. checkpoint) race with the size rotations.
+        for (std::size_t i = 0; i < reopensCount; i++) {
+            LOG_MANAGER->initialize();
+        }
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        // then
+        std::vector<std::uint8_t> received(threadsCount * messagesPerThread, 0);
+        std::size_t files = 0;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            std::fill(received.begin(), received.end(), 0);
+            files = 0;
+            std::size_t lines = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                for (std::string line; std::getline(inFile, line); lines++) {
+                    std::size_t thread, message;
+                    std::istringstream stream(line.substr(line.find("Rotated log") + 11));
+                    if (stream >> thread >> message && thread < threadsCount && message < messagesPerThread) {
+                        received[thread * messagesPerThread + message]++;
+                    }
+                }
+
+                files++;
+            }
+
+            return lines >= threadsCount * messagesPerThread;
+        }));
+
+        settingsGuard.restore();
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_TEST_MESSAGE("Rotated files: " << files);
+        BOOST_CHECK_GT(files, 1000);
+        BOOST_CHECK(std::all_of(received.begin(), received.end(), [](std::uint8_t _count) {
+            return _count == 1;
+        }));
+    }
+
+#ifdef LOGCPLUS_WITH_ZLIB
+    BOOST_AUTO_TEST_CASE(rotatedLogFilesShouldBeCompressedInBackground)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "rotatedLogFilesShouldBeCompressedInBackground";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        // given
+        constexpr std::size_t messagesCount = 2000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setMaxFileSize(4, logcplus::filesize_t::SizeUnit::KiB);
+        LOG_MANAGER->setCompression(logcplus::Logger::Compression::Gzip);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Compressed log", i);
+        }
+
+        // then
+        std::size_t lines = 0, compressedFiles = 0, otherFiles = 0;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            lines = compressedFiles = otherFiles = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::string content;
+                if (file.path().extension() == ".gz") {
+                    gzFile input = gzopen(file.path().c_str(), "rb");
+                    char buffer[4096];
+                    for (int read; (read = gzread(input, buffer, sizeof(buffer))) > 0;) {
+                        content.append(buffer, static_cast<std::size_t>(read));
+                    }
+                    gzclose(input);
+                    compressedFiles++;
+                } else {
+                    std::ifstream inFile(file.path());
+                    content.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+                    otherFiles++;
+                }
+
+                lines += static_cast<std::size_t>(std::count(content.begin(), content.end(), '\n'));
+            }
+
+            // Only the active log file is not compressed.
+            return lines == messagesCount && otherFiles == 1;
+        }));
+
+        LOG_MANAGER->setCompression(logcplus::Logger::Compression::None);
+        settingsGuard.restore();
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_TEST_MESSAGE("Compressed files: " << compressedFiles);
+        BOOST_CHECK_EQUAL(lines, messagesCount);
+        BOOST_CHECK_EQUAL(otherFiles, 1);
+        BOOST_CHECK_GT(compressedFiles, 1);
+        // Retention removes the compressed files too.
+        BOOST_CHECK(std::regex_match("2024-01-31.log.12.gz", std::regex(LOG_FILE_FORMAT)));
+        BOOST_CHECK(!std::regex_match("2024-01-31.log.12.gz.tmp", std::regex(LOG_FILE_FORMAT)));
+    }
+#endif
+
+#ifdef LOGCPLUS_WITH_ZLIB
+    BOOST_AUTO_TEST_CASE(gzipSinkShouldBeReadableUpToLastCompleteBlock)
+    {
+        // setup
+        auto decompress = [](const std::string& _path) {
+            std::string content;
+            gzFile input = gzopen(_path.c_str(), "rb");
+            char buffer[4096];
+            for (int read; (read = gzread(input, buffer, sizeof(buffer))) > 0;) {
+                content.append(buffer, static_cast<std::size_t>(read));
+            }
+            gzclose(input);
+
+            return content;
+        };
+
+        auto logPath = TEMP_DIRECTORY + directorySeparator() + "gzipSinkShouldBeReadableUpToLastCompleteBlock.log.gz";
+        auto truncatedPath = logPath + ".truncated";
+        std::filesystem::remove(logPath);
+
+        // given
+        constexpr std::size_t messagesCount = 5000;
+        auto sink = std::make_shared<logcplus::GzipFileSink>(4096);
+        BOOST_REQUIRE(sink->open(logPath));
+        auto coutHandler = redirectStdOutToTemporaryFile("gzipSinkShouldBeReadableUpToLastCompleteBlock");
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->addSink(sink);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Compressed log", i);
+        }
+
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([]() -> bool {
+            return getLogsFromFile("gzipSinkShouldBeReadableUpToLastCompleteBlock").size() == messagesCount;
+        }));
+
+        // Crash in the middle of the block: only complete blocks are in the file.
+        LOG_MANAGER->removeSink(sink);
+        std::filesystem::copy_file(logPath, truncatedPath, std::filesystem::copy_options::overwrite_existing);
+        sink->close();
+        delete coutHandler;
+
+        // then
+        std::string content = decompress(logPath);
+        std::string truncatedContent = decompress(truncatedPath);
+        auto uncompressedSize = static_cast<double>(content.size());
+        auto compressedSize = static_cast<double>(std::filesystem::file_size(logPath));
+        std::filesystem::remove(logPath);
+        std::filesystem::remove(truncatedPath);
+
+        BOOST_TEST_MESSAGE("Compression ratio: " << uncompressedSize / compressedSize);
+        BOOST_CHECK_EQUAL(std::count(content.begin(), content.end(), '\n'), messagesCount);
+        BOOST_CHECK(content.find("Compressed log " + std::to_string(messagesCount - 1)) != std::string::npos);
+        BOOST_CHECK_GT(std::count(truncatedContent.begin(), truncatedContent.end(), '\n'), 0);
+        BOOST_CHECK(content.compare(0, truncatedContent.size(), truncatedContent) == 0);
+        BOOST_CHECK_EQUAL(truncatedContent.back(), '\n');
+    }
+#endif
+
+    BOOST_AUTO_TEST_CASE(binaryLogShouldBeDecodedToSameTextAsDefaultFormat)
+    {
+        // setup
+        auto binaryLogPath = TEMP_DIRECTORY + directorySeparator() + "binaryLogShouldBeDecodedToSameText.bin";
+        std::filesystem::remove(binaryLogPath);
+        auto coutHandler = redirectStdOutToTemporaryFile("binaryLogShouldBeDecodedToSameText");
+
+        // given
+        constexpr std::size_t messagesCount = 500;
+        auto sink = std::make_shared<logcplus::BinaryFileSink>();
+        BOOST_REQUIRE(sink->open(binaryLogPath));
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        LOG_MANAGER->addSink(sink);
+        auto logger = logcplus::LogManager::getLogger();
+        std::string longText(1000, 'x');
+
+        // when
+        for (auto formattingMode: {logcplus::Logger::FormattingMode::Eager, logcplus::Logger::FormattingMode::Deferred}) {
+            LOG_MANAGER->setFormattingMode(formattingMode);
+            LOG_MANAGER->initialize();
+
+            for (std::size_t i = 0; i < messagesCount; i++) {
+                logger->info("Binary log", i, -2.5, 'c', std::string("text"));
+                logger->warn(i, "number first");
+                logger->error("Long", longText);
+                logger->debug();
+            }
+        }
+
+        std::vector<std::string> logs;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logs]() -> bool {
+            logs = getLogsFromFile("binaryLogShouldBeDecodedToSameText");
+            return logs.size() == 8 * messagesCount;
+        }));
+
+        LOG_MANAGER->removeSink(sink);
+        sink->close();
+        delete coutHandler;
+        LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Eager);
+
+        // then
+        std::ifstream binaryLog(binaryLogPath, std::ios::binary);
+        std::stringstream decoded;
+        BOOST_CHECK(logcplus::BinaryLogDecoder::decode(binaryLog, decoded));
+
+        std::vector<std::string> decodedLogs;
+        for (std::string line; std::getline(decoded, line);) {
+            decodedLogs.push_back(line);
+        }
+
+        // Truncated log is decoded up to the last complete record.
+        std::ifstream truncatedLog(binaryLogPath, std::ios::binary);
+        std::string truncatedContent(std::istreambuf_iterator<char>(truncatedLog), {});
+        truncatedContent.resize(truncatedContent.size() - 5);
+        std::istringstream truncatedInput(truncatedContent);
+        std::stringstream truncatedDecoded;
+        BOOST_CHECK(!logcplus::BinaryLogDecoder::decode(truncatedInput, truncatedDecoded));
+
+        auto binarySize = std::filesystem::file_size(binaryLogPath);
+        std::filesystem::remove(binaryLogPath);
+
+        BOOST_TEST_MESSAGE("Binary log size: " << binarySize);
+        BOOST_REQUIRE_EQUAL(decodedLogs.size(), logs.size());
+        for (std::size_t i = 0; i < logs.size(); i++) {
+            BOOST_REQUIRE_EQUAL(decodedLogs[i], logs[i]);
+        }
+        BOOST_CHECK_EQUAL(std::count(std::istreambuf_iterator<char>(truncatedDecoded), {}, '\n'), logs.size() - 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(rotatedBinaryLogShouldStartWithHeaderAndOwnStringTable)
+    {
+        // setup
+        auto firstPath = TEMP_DIRECTORY + directorySeparator() + "rotatedBinaryLog.1.bin";
+        auto secondPath = TEMP_DIRECTORY + directorySeparator() + "rotatedBinaryLog.2.bin";
+        std::filesystem::remove(firstPath);
+        std::filesystem::remove(secondPath);
+        auto coutHandler = redirectStdOutToTemporaryFile("rotatedBinaryLogShouldStartWithHeader");
+
+        // given
+        constexpr std::size_t messagesCount = 100;
+        auto sink = std::make_shared<logcplus::BinaryFileSink>();
+        std::shared_ptr<logcplus::FileSink> fileSink = sink;
+        BOOST_REQUIRE(fileSink->open(firstPath));
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Deferred);
+        LOG_MANAGER->initialize();
+        auto logger = logcplus::LogManager::getLogger();
+
+        auto logAndWait = [&logger, &sink](const std::size_t _first) {
+            LOG_MANAGER->addSink(sink);
+            for (std::size_t i = _first; i < _first + messagesCount; i++) {
+                logger->info("Rotated binary log", i);
+            }
+
+            BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([_first]() -> bool {
+                return getLogsFromFile("rotatedBinaryLogShouldStartWithHeader").size() == _first + messagesCount;
+            }));
+            LOG_MANAGER->removeSink(sink);
+        };
+
+        // when
+        logAndWait(0);
+        logcplus::FileSink::release(fileSink->reopen(secondPath));
+        logAndWait(messagesCount);
+        sink->close();
+
+        auto logs = getLogsFromFile("rotatedBinaryLogShouldStartWithHeader");
+        delete coutHandler;
+        LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Eager);
+
+        std::vector<std::string> decodedLogs;
+        std::vector<bool> decoded;
+        for (const auto& path: {firstPath, secondPath}) {
+            std::ifstream binaryLog(path, std::ios::binary);
+            std::stringstream output;
+            decoded.push_back(logcplus::BinaryLogDecoder::decode(binaryLog, output));
+            for (std::string line; std::getline(output, line);) {
+                decodedLogs.push_back(line);
+            }
+            binaryLog.close();
+            std::filesystem::remove(path);
+        }
+
+        // then
+        BOOST_CHECK((decoded == std::vector<bool>{true, true}));
+        BOOST_REQUIRE_EQUAL(decodedLogs.size(), logs.size());
+        for (std::size_t i = 0; i < logs.size(); i++) {
+            BOOST_CHECK_EQUAL(decodedLogs[i], logs[i]);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(binaryFormatterShouldWriteLeadingStringsInlineWhenStringTableIsFull)
+    {
+        // given
+        logcplus::BinaryFormatter formatter(2);
+        std::string binaryLog(logcplus::BinaryFormatter::MAGIC, sizeof(logcplus::BinaryFormatter::MAGIC));
+        const std::vector<std::string> leadingStrings = {"First", "Second", "Third", "First", "Fourth", "Third"};
+        std::vector<bool> defined;
+
+        // when
+        for (std::size_t i = 0; i < leadingStrings.size(); i++) {
+            logcplus::LogRecord record;
+            record.level = logcplus::Logger::LogLevel::Info;
+            record.timestamp = std::chrono::system_clock::now();
+            record.deferred = true;
+            logcplus::LogArguments::pack(record, leadingStrings[i], i);
+
+            std::string output;
+            formatter.format(record, output);
+            defined.push_back(output.front() == static_cast<char>(logcplus::BinaryFormatter::DEFINITION));
+            binaryLog.append(output).push_back('\n');
+        }
+
+        std::istringstream input(binaryLog);
+        std::stringstream decoded;
+        bool decodedAll = logcplus::BinaryLogDecoder::decode(input, decoded);
+
+        // then
+        BOOST_CHECK(decodedAll);
+        BOOST_CHECK((defined == std::vector<bool>{true, true, false, false, false, false}));
+
+        std::size_t i = 0;
+        for (std::string line; std::getline(decoded, line); i++) {
+            BOOST_REQUIRE(i < leadingStrings.size());
+            std::string message = " - " + leadingStrings[i] + " " + std::to_string(i);
+            BOOST_CHECK_EQUAL(line.substr(line.size() - std::min(line.size(), message.size())), message);
+        }
+        BOOST_CHECK_EQUAL(i, leadingStrings.size());
+    }
+
+    BOOST_AUTO_TEST_CASE(mappedLogFileOfKilledProcessShouldBeTruncatedWhenLoggerStarts)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "mappedLogFileOfKilledProcessShouldBeContinued";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        auto countLines = [&logDirectory]() {
+            std::size_t lines = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                lines += static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(inFile), {}, '\n'));
+            }
+
+            return lines;
+        };
+
+        // given
+        constexpr std::size_t messagesCount = 1000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setFileBackend(logcplus::Logger::FileBackend::Mmap);
+        // Forked child has only the forking thread, the logger is started again in the child.
+        LOG_MANAGER->shutdown();
+
+        // Killed process leaves the file preallocated (padded with zeros).
+        pid_t child = fork();
+        if (child == 0) {
+            LOG_MANAGER->initialize();
+            auto logger = logcplus::LogManager::getLogger();
+            for (std::size_t i = 0; i < messagesCount; i++) {
+                logger->info("Killed process log", i);
+            }
+
+            // Mapped pages are shared with the page cache, written messages are visible in the file.
+            while (countLines() < messagesCount) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::raise(SIGKILL);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        std::uintmax_t paddedSize = 0;
+        for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+            paddedSize += std::filesystem::file_size(file.path());
+        }
+
+        // when
+        LOG_MANAGER->initialize();
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Reopened log", i);
+        }
+
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&countLines]() -> bool {
+            return countLines() == 2 * messagesCount;
+        }));
+
+        // Closes (and truncates) the file.
+        settingsGuard.restore();
+
+        // then (the file of the killed process is rotated on start, it's truncated on the background thread)
+        std::size_t killedLines = 0, reopenedLines = 0, files = 0, zeros = 0;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            killedLines = reopenedLines = files = zeros = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                std::string content(std::istreambuf_iterator<char>(inFile), {});
+                zeros += static_cast<std::size_t>(std::count(content.begin(), content.end(), '\0'));
+                std::istringstream stream(content);
+                for (std::string line; std::getline(stream, line);) {
+                    killedLines += line.find("Killed process log") != std::string::npos ? 1 : 0;
+                    reopenedLines += line.find("Reopened log") != std::string::npos ? 1 : 0;
+                }
+                files++;
+            }
+
+            return zeros == 0;
+        }));
+
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+        BOOST_CHECK_GE(paddedSize, logcplus::FileSink::DEFAULT_SEGMENT_SIZE);
+        BOOST_CHECK_EQUAL(files, 2);
+        BOOST_CHECK_EQUAL(zeros, 0);
+        BOOST_CHECK_EQUAL(killedLines, messagesCount);
+        BOOST_CHECK_EQUAL(reopenedLines, messagesCount);
+    }
+
+    BOOST_AUTO_TEST_CASE(mappedFileSinkShouldAppendAfterWrittenDataOfNotTruncatedFile)
+    {
+        // setup
+        auto path = TEMP_DIRECTORY + directorySeparator() + "mappedFileSinkShouldAppendAfterWrittenData.log";
+        std::filesystem::remove(path);
+
+        // given (mapped file of the killed process: written data followed by the preallocated zeros)
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << "Killed process log\n" << std::string(100000, '\0');
+        }
+
+        // when
+        logcplus::FileSink sink;
+        sink.setSegmentSize(4096);
+        BOOST_REQUIRE(sink.open(path));
+        std::uintmax_t sizeAfterOpen = sink.size();
+        BOOST_CHECK(sink.write("Reopened log\n", 13));
+        sink.close();
+
+        // then
+        std::ifstream file(path, std::ios::binary);
+        std::string content(std::istreambuf_iterator<char>(file), {});
+        std::filesystem::remove(path);
+
+        BOOST_CHECK_EQUAL(sizeAfterOpen, 19);
+        BOOST_CHECK_EQUAL(content, "Killed process log\nReopened log\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(mappedLogFilesShouldBeTruncatedToWrittenSize)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "mappedLogFilesShouldBeTruncatedToWrittenSize";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        // given
+        constexpr std::size_t messagesCount = 5000;
+        constexpr std::uintmax_t maxFileSize = 16384;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setMaxFileSize(maxFileSize, logcplus::filesize_t::SizeUnit::B);
+        LOG_MANAGER->setFileBackend(logcplus::Logger::FileBackend::Mmap);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Mapped log", i);
+        }
+
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logDirectory]() -> bool {
+            std::size_t lines = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                lines += static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(inFile), {}, '\n'));
+            }
+
+            return lines == messagesCount;
+        }));
+
+        // Closes (and truncates) the active file.
+        settingsGuard.restore();
+
+        // then
+        std::size_t lines = 0, files = 0;
+        std::uintmax_t largestFile = 0;
+        bool padded = true;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            lines = files = 0;
+            largestFile = 0;
+            padded = false;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                std::string content(std::istreambuf_iterator<char>(inFile), {});
+                lines += static_cast<std::size_t>(std::count(content.begin(), content.end(), '\n'));
+                padded |= content.empty() || content.back() != '\n';
+                largestFile = std::max(largestFile, std::filesystem::file_size(file.path()));
+                files++;
+            }
+
+            // Rotated files are truncated on the background thread.
+            return !padded;
+        }));
+
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_TEST_MESSAGE("Files: " << files << ", largest file: " << largestFile);
+        BOOST_CHECK(!padded);
+        BOOST_CHECK_EQUAL(lines, messagesCount);
+        BOOST_CHECK_LE(largestFile, maxFileSize);
+        BOOST_CHECK_GT(files, 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(asynchronousFileWritesShouldKeepEveryMessageOnceAcrossRotations)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "asynchronousFileWritesShouldKeepEveryMessageOnceAcrossRotations";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        // given
+        constexpr std::size_t threadsCount = 4;
+        constexpr std::size_t messagesPerThread = 20000;
+        constexpr std::uintmax_t maxFileSize = 65536;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setMaxFileSize(maxFileSize, logcplus::filesize_t::SizeUnit::B);
+        LOG_MANAGER->setFileBackend(logcplus::Logger::FileBackend::IoUring);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        std::vector<std::thread> producers;
+        for (std::size_t thread = 0; thread < threadsCount; thread++) {
+            producers.emplace_back([logger, thread]() {
+                for (std::size_t i = 0; i < messagesPerThread; i++) {
+                    logger->info("Async log", thread, i);
+                }
+            });
+        }
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&logDirectory]() -> bool {
+            std::size_t lines = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                lines += static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(inFile), {}, '\n'));
+            }
+
+            return lines >= threadsCount * messagesPerThread;
+        }));
+
+        // Waits for the writes in flight and closes the active file.
+        settingsGuard.restore();
+
+        // then
+        std::vector<std::uint8_t> received(threadsCount * messagesPerThread, 0);
+        std::size_t files = 0;
+        std::uintmax_t largestFile = 0;
+        for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+            std::ifstream inFile(file.path());
+            for (std::string line; std::getline(inFile, line);) {
+                std::size_t thread, message;
+                std::istringstream stream(line.substr(line.find("Async log") + 9));
+                if (stream >> thread >> message && thread < threadsCount && message < messagesPerThread) {
+                    received[thread * messagesPerThread + message]++;
+                }
+            }
+
+            largestFile = std::max(largestFile, std::filesystem::file_size(file.path()));
+            files++;
+        }
+
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_TEST_MESSAGE("Files: " << files << ", largest file: " << largestFile);
+        BOOST_CHECK_LE(largestFile, maxFileSize);
+        BOOST_CHECK_GT(files, 1);
+        BOOST_CHECK(std::all_of(received.begin(), received.end(), [](std::uint8_t _count) {
+            return _count == 1;
+        }));
+    }
+
+    BOOST_AUTO_TEST_CASE(asynchronousFileWriteShouldFallBackToSynchronousWriteWhenSubmissionFails)
+    {
+        // setup
+        auto path = TEMP_DIRECTORY + directorySeparator() + "asynchronousFileWriteShouldFallBack.log";
+        std::filesystem::remove(path);
+
+        auto ioUringDescriptors = []() {
+            std::set<int> descriptors;
+            for (const auto& entry: std::filesystem::directory_iterator("/proc/self/fd")) {
+                std::error_code errorCode;
+                auto target = std::filesystem::read_symlink(entry.path(), errorCode);
+                if (!errorCode && target.string().find("io_uring") != std::string::npos) {
+                    descriptors.insert(std::stoi(entry.path().filename().string()));
+                }
+            }
+
+            return descriptors;
+        };
+
+        // given
+        auto existing = ioUringDescriptors();
+        logcplus::FileSink sink;
+        sink.setAsyncWrites(true);
+        BOOST_REQUIRE(sink.open(path));
+        std::string first = "First batch\n";
+        BOOST_CHECK(sink.write(first));
+        sink.drain();
+
+        // io_uring_enter fails on the descriptor which is not the ring anymore.
+        int devNull = ::open("/dev/null", O_RDWR | O_CLOEXEC);
+        for (int descriptor: ioUringDescriptors()) {
+            if (existing.count(descriptor) == 0) {
+                ::dup2(devNull, descriptor);
+            }
+        }
+        ::close(devNull);
+
+        // when
+        std::string second = "Second batch\n";
+        bool written = sink.write(second);
+        std::string third = "Third batch\n";
+        bool writtenAfterFailure = sink.write(third);
+        std::uintmax_t size = sink.size();
+        std::uint64_t failedWrites = sink.takeFailedWrites();
+        sink.close();
+
+        // then
+        std::ifstream file(path, std::ios::binary);
+        std::string content(std::istreambuf_iterator<char>(file), {});
+        std::filesystem::remove(path);
+
+        BOOST_CHECK(written);
+        BOOST_CHECK(writtenAfterFailure);
+        BOOST_CHECK_EQUAL(failedWrites, 0);
+        BOOST_CHECK_EQUAL(size, content.size());
+        BOOST_CHECK_EQUAL(content, "First batch\nSecond batch\nThird batch\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(errorShouldBeWrittenAndSyncedWithAllPreviousMessagesInSingleSync)
+    {
+        // setup
+        class SyncedSink : public logcplus::LogSink {
+        public:
+            using logcplus::LogSink::LogSink;
+
+            std::atomic<std::size_t> written{0};
+            std::atomic<std::size_t> synced{0};
+            std::atomic<std::size_t> syncs{0};
+
+            void write(struct iovec* _lines, std::size_t _count) override {
+                for (std::size_t i = 0; i < _count; i++) {
+                    const char* data = static_cast<const char*>(_lines[i].iov_base);
+                    written += static_cast<std::size_t>(std::count(data, data + _lines[i].iov_len, '\n'));
+                }
+            }
+
+            void sync() override {
+                synced = written.load();
+                syncs++;
+            }
+        };
+
+        auto coutHandler = redirectStdOutToTemporaryFile("errorShouldBeWrittenAndSyncedWithAllPreviousMessages");
+
+        // given
+        constexpr std::size_t messagesCount = 1000;
+        auto sink = std::make_shared<SyncedSink>(logcplus::LogLevel::Debug);
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        // Messages are kept in the write buffer until the error.
+        LOG_MANAGER->setFlushPolicy(logcplus::Logger::FlushPolicy::Interval);
+        LOG_MANAGER->setFlushInterval(std::chrono::minutes(10));
+        LOG_MANAGER->setSyncPolicy(logcplus::Logger::SyncPolicy::OnError);
+        LOG_MANAGER->addSink(sink);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Info log", i);
+        }
+        logger->error("Error log");
+
+        // then
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&sink]() -> bool {
+            return sink->syncs.load() > 0;
+        }));
+
+        std::size_t synced = sink->synced.load();
+        std::size_t syncs = sink->syncs.load();
+
+        LOG_MANAGER->removeSink(sink);
+        LOG_MANAGER->setSyncPolicy(logcplus::Logger::SyncPolicy::None);
+        LOG_MANAGER->setFlushPolicy(logcplus::Logger::FlushPolicy::EveryBatch);
+        LOG_MANAGER->setFlushInterval(std::chrono::milliseconds(100));
+        LOG_MANAGER->initialize();
+        delete coutHandler;
+
+        BOOST_CHECK_EQUAL(syncs, 1);
+        BOOST_CHECK_EQUAL(synced, messagesCount + 1);
+        BOOST_CHECK_EQUAL(getLogsFromFile("errorShouldBeWrittenAndSyncedWithAllPreviousMessages").size(), messagesCount + 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(crashHandlerShouldWritePendingMessagesBeforeProcessTerminates)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "crashHandlerShouldWritePendingMessagesBeforeProcessTerminates";
+        std::filesystem::remove_all(logDirectory);
+
+        // given
+        constexpr std::size_t messagesCount = 10000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        // Forked child has only the forking thread, the logger is started again in the child.
+        LOG_MANAGER->shutdown();
+
+        // when
+        pid_t child = fork();
+        if (child == 0) {
+            // Test framework handles SIGSEGV too, the default action terminates the child.
+            std::signal(SIGSEGV, SIG_DFL);
+
+            LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+            LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+            LOG_MANAGER->setLogDirectory(logDirectory);
+            // Messages are kept in the write buffer, they would be lost without the crash handler.
+            LOG_MANAGER->setFlushPolicy(logcplus::Logger::FlushPolicy::Interval);
+            LOG_MANAGER->setFlushInterval(std::chrono::minutes(10));
+            LOG_MANAGER->initialize();
+            LOG_MANAGER->enableCrashHandler();
+
+            auto logger = logcplus::LogManager::getLogger();
+            for (std::size_t i = 0; i < messagesCount; i++) {
+                logger->info("Crash log", i);
+            }
+
+            std::raise(SIGSEGV);
+            std::_Exit(0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        LOG_MANAGER->initialize();
+
+        // then
+        std::vector<std::string> lines;
+        for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+            std::ifstream inFile(file.path());
+            for (std::string line; std::getline(inFile, line);) {
+                lines.push_back(line);
+            }
+        }
+
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+        BOOST_REQUIRE_EQUAL(lines.size(), messagesCount + 1);
+        BOOST_CHECK(lines[messagesCount - 1].find("Crash log " + std::to_string(messagesCount - 1)) != std::string::npos);
+        BOOST_CHECK(lines[messagesCount].rfind("[FATAL] ", 0) == 0);
+        BOOST_CHECK(lines[messagesCount].find(" - Fatal signal SIGSEGV received") != std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE(crashHandlerShouldWriteFatalLineOnStackOverflow)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "crashHandlerShouldWriteFatalLineOnStackOverflow";
+        std::filesystem::remove_all(logDirectory);
+
+        // given
+        constexpr std::size_t messagesCount = 100;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->shutdown();
+
+        // when
+        pid_t child = fork();
+        if (child == 0) {
+            std::signal(SIGSEGV, SIG_DFL);
+
+            LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+            LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+            LOG_MANAGER->setLogDirectory(logDirectory);
+            LOG_MANAGER->initialize();
+            LOG_MANAGER->enableCrashHandler();
+
+            auto logger = logcplus::LogManager::getLogger();
+            for (std::size_t i = 0; i < messagesCount; i++) {
+                logger->info("Crash log", i);
+            }
+
+            overflowStack(0);
+            std::_Exit(0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        LOG_MANAGER->initialize();
+
+        // then
+        std::vector<std::string> lines;
+        for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+            std::ifstream inFile(file.path());
+            for (std::string line; std::getline(inFile, line);) {
+                lines.push_back(line);
+            }
+        }
+
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+        BOOST_REQUIRE_EQUAL(lines.size(), messagesCount + 1);
+        BOOST_CHECK(lines[messagesCount].find(" - Fatal signal SIGSEGV received") != std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE(crashHandlerShouldTerminateProcessWhenCrashingThreadHoldsSinksLock)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "crashHandlerShouldTerminateProcessWhenCrashingThreadHoldsSinksLock";
+        std::filesystem::remove_all(logDirectory);
+
+        // Sinks are written by the queue worker holding the sinks lock.
+        class CrashingSink : public logcplus::LogSink {
+        public:
+            using logcplus::LogSink::LogSink;
+
+            void write(struct iovec* _lines, std::size_t _count) override {
+                for (std::size_t i = 0; i < _count; i++) {
+                    if (std::string_view(static_cast<const char*>(_lines[i].iov_base), _lines[i].iov_len).find("Crash") != std::string_view::npos) {
+                        std::raise(SIGSEGV);
+                    }
+                }
+            }
+        };
+
+        // given
+        constexpr std::size_t messagesCount = 100;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        // Forked child has only the forking thread, the logger is started again in the child.
+        LOG_MANAGER->shutdown();
+
+        // when
+        auto start = std::chrono::steady_clock::now();
+        pid_t child = fork();
+        if (child == 0) {
+            // Test framework handles SIGSEGV too, the default action terminates the child.
+            std::signal(SIGSEGV, SIG_DFL);
+
+            LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+            LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+            LOG_MANAGER->setLogDirectory(logDirectory);
+            LOG_MANAGER->setFlushPolicy(logcplus::Logger::FlushPolicy::EveryBatch);
+            LOG_MANAGER->addSink(std::make_shared<CrashingSink>());
+            LOG_MANAGER->initialize();
+            LOG_MANAGER->enableCrashHandler();
+
+            auto logger = logcplus::LogManager::getLogger();
+            for (std::size_t i = 0; i < messagesCount; i++) {
+                logger->info("Log", i);
+            }
+            logger->info("Crash");
+
+            std::this_thread::sleep_for(std::chrono::seconds(30));
+            std::_Exit(0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        LOG_MANAGER->initialize();
+
+        // then
+        std::vector<std::string> lines;
+        for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+            std::ifstream inFile(file.path());
+            for (std::string line; std::getline(inFile, line);) {
+                lines.push_back(line);
+            }
+        }
+
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+        BOOST_CHECK(elapsed < std::chrono::milliseconds(LOGCPLUS_CRASH_FLUSH_TIMEOUT) + std::chrono::seconds(5));
+        BOOST_REQUIRE(!lines.empty());
+        BOOST_CHECK(lines.back().rfind("[FATAL] ", 0) == 0);
+        BOOST_CHECK(lines.back().find(" - Fatal signal SIGSEGV received") != std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE(messagesQueuedBeforeProcessWasKilledShouldBeRecoveredFromSharedMemoryRing)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "messagesQueuedBeforeProcessWasKilledShouldBeRecovered";
+        std::filesystem::remove_all(logDirectory);
+
+        // given
+        constexpr std::size_t messagesCount = 5000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        // Forked child has only the forking thread, the logger is started again in the child.
+        LOG_MANAGER->shutdown();
+
+        // when
+        pid_t child = fork();
+        if (child == 0) {
+            LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+            LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+            LOG_MANAGER->setLogDirectory(logDirectory);
+            LOG_MANAGER->setFormattingMode(logcplus::Logger::FormattingMode::Deferred);
+            // Messages are kept in the write buffer, they're lost when the process is killed.
+            LOG_MANAGER->setFlushPolicy(logcplus::Logger::FlushPolicy::Interval);
+            LOG_MANAGER->setFlushInterval(std::chrono::minutes(10));
+            LOG_MANAGER->setSharedMemoryRing(true, logcplus::filesize_t(4, logcplus::filesize_t::SizeUnit::MiB));
+            LOG_MANAGER->initialize();
+
+            auto logger = logcplus::LogManager::getLogger();
+            for (std::size_t i = 0; i < messagesCount; i++) {
+                logger->info("Ring log", i, 0.5);
+            }
+
+            std::raise(SIGKILL);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        LOG_MANAGER->initialize();
+
+        auto ring = logcplus::SharedMemoryRing::defaultPath().parent_path() / ("logcplus-" + std::to_string(child) + ".ring");
+        std::ostringstream output;
+        auto owner = logcplus::SharedMemoryRing::owner(ring);
+        auto recovered = logcplus::SharedMemoryRing::recover(ring, output);
+
+        // then
+        std::size_t written = 0;
+        for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+            std::ifstream inFile(file.path());
+            written += static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(inFile), {}, '\n'));
+        }
+
+        std::filesystem::remove(ring);
+        std::filesystem::remove_all(logDirectory);
+
+        BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+        BOOST_REQUIRE(owner.has_value());
+        BOOST_CHECK_EQUAL(owner.value(), child);
+        BOOST_REQUIRE(recovered.has_value());
+        BOOST_CHECK_EQUAL(written, 0);
+        BOOST_CHECK_EQUAL(recovered.value(), messagesCount);
+
+        std::istringstream lines(output.str());
+        std::size_t message = 0;
+        const std::regex linePattern(R"(\[INFO\] \d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2} - Ring log (\d+) 0\.500000)");
+        for (std::string line; std::getline(lines, line); message++) {
+            std::smatch match;
+            BOOST_REQUIRE(std::regex_match(line, match, linePattern));
+            BOOST_CHECK_EQUAL(match[1].str(), std::to_string(message));
+        }
+        BOOST_CHECK_EQUAL(message, messagesCount);
+    }
+
+    BOOST_AUTO_TEST_CASE(recentMessagesBelowLogLevelShouldBeWrittenBeforeErrorAndOnRequest)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("recentMessagesBelowLogLevelShouldBeWritten");
+
+        // given
+        constexpr std::size_t backtraceSize = 10;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setBacktraceSize(backtraceSize);
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < 25; i++) {
+            logger->debug("Debug log", i);
+        }
+        logger->info("Info log");
+        logger->error("Error log");
+        for (std::size_t i = 25; i < 30; i++) {
+            LOGCPLUS_DEBUG(logger, "Debug log", i);
+        }
+        logger->dumpBacktrace();
+
+        // then
+        std::vector<std::string> lines;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&lines]() -> bool {
+            lines = getLogsFromFile("recentMessagesBelowLogLevelShouldBeWritten");
+            return lines.size() >= 21;
+        }));
+
+        LOG_MANAGER->setBacktraceSize(0);
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        LOG_MANAGER->initialize();
+        delete coutHandler;
+
+        std::vector<std::string> messages;
+        for (const auto& line: lines) {
+            messages.push_back(line.substr(line.find(" - ") + 3));
+        }
+
+        std::vector<std::string> expected = {"Info log", "logcplus: backtrace of 10 messages"};
+        for (std::size_t i = 15; i < 25; i++) {
+            expected.push_back("Debug log " + std::to_string(i));
+        }
+        expected.insert(expected.end(), {"logcplus: end of backtrace", "Error log", "logcplus: backtrace of 5 messages"});
+        for (std::size_t i = 25; i < 30; i++) {
+            expected.push_back("Debug log " + std::to_string(i));
+        }
+        expected.push_back("logcplus: end of backtrace");
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(messages.begin(), messages.end(), expected.begin(), expected.end());
+        BOOST_REQUIRE_EQUAL(lines.size(), expected.size());
+        BOOST_CHECK(lines[2].rfind("[DEBUG] ", 0) == 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(backtraceDumpRequestShouldNotBeDroppedWhenQueueIsFull)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("backtraceDumpRequestShouldNotBeDropped");
+
+        // given
+        constexpr std::size_t messagesCount = 20000;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setBacktraceSize(10);
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked, 8);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::DropNewest);
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (std::size_t i = 0; i < 3; i++) {
+            logger->debug("Backtraced log", i);
+        }
+        for (std::size_t i = 0; i < messagesCount; i++) {
+            logger->info("Overflow log", i);
+        }
+        logger->dumpBacktrace();
+
+        // then
+        std::vector<std::string> lines;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&lines]() -> bool {
+            lines = getLogsFromFile("backtraceDumpRequestShouldNotBeDropped");
+            return std::any_of(lines.begin(), lines.end(), [](const std::string& _line) {
+                return _line.find("logcplus: end of backtrace") != std::string::npos;
+            });
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        LOG_MANAGER->shutdown();
+        LOG_MANAGER->setQueueType(logcplus::Logger::QueueType::Locked);
+        LOG_MANAGER->setOverflowPolicy(logcplus::Logger::OverflowPolicy::Block);
+        LOG_MANAGER->setBacktraceSize(0);
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        LOG_MANAGER->initialize();
+        delete coutHandler;
+
+        const std::regex droppedRegex(R"(.*dropped \d+ messages \(DEBUG: (\d+) .*)");
+        for (const auto& line: lines) {
+            std::smatch match;
+            if (std::regex_match(line, match, droppedRegex)) {
+                BOOST_CHECK_EQUAL(match[1].str(), "0");
+            }
+        }
+
+        auto backtraced = std::count_if(lines.begin(), lines.end(), [](const std::string& _line) {
+            return _line.find("Backtraced log") != std::string::npos;
+        });
+        BOOST_CHECK_EQUAL(backtraced, 3);
+        BOOST_CHECK_EQUAL(after.enqueued[0], before.enqueued[0]);
+        BOOST_CHECK_EQUAL(after.dropped[0], before.dropped[0]);
+        BOOST_CHECK_EQUAL(after.enqueued[1] + after.dropped[1] - before.enqueued[1] - before.dropped[1], messagesCount);
+    }
+
+    BOOST_AUTO_TEST_CASE(latencyHistogramPercentilesShouldBeWithinBucketPrecision)
+    {
+        // given
+        logcplus::LatencyHistogram histogram;
+
+        // when
+        for (std::int64_t value = 1; value <= 100000; value++) {
+            histogram.record(std::chrono::nanoseconds(value));
+        }
+
+        // then
+        auto summary = histogram.summary();
+        auto within = [](std::chrono::nanoseconds actual, double expected) {
+            return actual.count() >= expected && actual.count() <= expected * (1.0 + 1.0 / logcplus::LatencyHistogram::SUB_BUCKETS);
+        };
+
+        BOOST_CHECK_EQUAL(summary.count, 100000u);
+        BOOST_CHECK_EQUAL(summary.min.count(), 1);
+        BOOST_CHECK_EQUAL(summary.mean.count(), 50000);
+        BOOST_CHECK(within(summary.p50, 50000));
+        BOOST_CHECK(within(summary.p99, 99000));
+        BOOST_CHECK(within(summary.max, 100000));
+    }
+
+    BOOST_AUTO_TEST_CASE(latencyOfWrittenMessagesShouldBeMeasuredAndReportedPeriodically)
+    {
+        // setup
+        auto coutHandler = redirectStdOutToTemporaryFile("latencyOfWrittenMessagesShouldBeMeasured");
+
+        // given
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLatencyStatistics(true);
+        LOG_MANAGER->setLatencyReportInterval(std::chrono::milliseconds(50));
+        LOG_MANAGER->initialize();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        for (int i = 0; i < 100; i++) {
+            logger->info("Info log", i);
+        }
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([]() -> bool {
+            return getLogsFromFile("latencyOfWrittenMessagesShouldBeMeasured").size() >= 100;
+        }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        logger->info("Last log");
+
+        // then
+        std::vector<std::string> lines;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&lines]() -> bool {
+            lines = getLogsFromFile("latencyOfWrittenMessagesShouldBeMeasured");
+            return lines.size() >= 102;
+        }));
+        auto statistics = LOG_MANAGER->latencyStatistics();
+
+        LOG_MANAGER->setLatencyStatistics(false);
+        LOG_MANAGER->setLatencyReportInterval(std::chrono::milliseconds(0));
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        LOG_MANAGER->initialize();
+        delete coutHandler;
+
+        BOOST_CHECK_GE(statistics.queueWait.count, 101u);
+        BOOST_CHECK_GE(statistics.format.count, 101u);
+        BOOST_CHECK_GE(statistics.endToEnd.count, 101u);
+        BOOST_CHECK_GE(statistics.write.count, 1u);
+        BOOST_CHECK(statistics.queueWait.p50 <= statistics.queueWait.p99 && statistics.queueWait.p99 <= statistics.queueWait.max);
+        BOOST_CHECK(statistics.endToEnd.p50 >= statistics.queueWait.p50 && statistics.endToEnd.max >= statistics.queueWait.max);
+
+        std::regex report(R"(^\[INFO\] .* - logcplus: latency of 100 records \(ns\) queue wait p50 \d+ p99 \d+ max \d+ \| format p50 \d+ .*)"
+                          R"( \| end to end p50 \d+ p99 \d+ max \d+$)");
+        BOOST_CHECK(lines[100].find(" - Last log") != std::string::npos);
+        BOOST_CHECK(std::regex_match(lines[101], report));
+    }
+
+    BOOST_AUTO_TEST_CASE(pipelineStatisticsShouldCountRecordsBytesAndRotations)
+    {
+        // setup
+        auto logDirectory = std::filesystem::path(TEMP_DIRECTORY) / "pipelineStatisticsShouldCountRecordsBytesAndRotations";
+        std::filesystem::remove_all(logDirectory);
+        LogFileSettingsGuard settingsGuard;
+
+        // given
+        constexpr std::size_t threadsCount = 4;
+        constexpr std::size_t messagesPerThread = 500;
+        constexpr std::size_t errors = 10;
+        LOG_MANAGER->disableFileWatcher();
+        LOG_MANAGER->disableDirectoryWatcher();
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Info);
+        LOG_MANAGER->setLogMode(logcplus::Logger::LogMode::File);
+        LOG_MANAGER->setLogDirectory(logDirectory);
+        LOG_MANAGER->setMaxFileSize(4096, logcplus::filesize_t::SizeUnit::B);
+        LOG_MANAGER->initialize();
+        auto before = LOG_MANAGER->statistics();
+
+        // when
+        auto logger = logcplus::LogManager::getLogger();
+        std::vector<std::thread> producers;
+        for (std::size_t thread = 0; thread < threadsCount; thread++) {
+            producers.emplace_back([logger, thread]() {
+                for (std::size_t i = 0; i < messagesPerThread; i++) {
+                    logger->info("Counted log", thread, i);
+                }
+            });
+        }
+        for (std::size_t i = 0; i < errors; i++) {
+            logger->error("Counted error", i);
+        }
+        logger->debug("Not counted log");
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        // then
+        std::size_t lines = 0, files = 0;
+        std::uintmax_t bytes = 0;
+        BOOST_CHECK_NO_THROW(PredefinedPollingConditions::WAIT.eventually([&]() -> bool {
+            lines = files = 0;
+            bytes = 0;
+            for (const auto& file: std::filesystem::directory_iterator(logDirectory)) {
+                std::ifstream inFile(file.path());
+                lines += static_cast<std::size_t>(std::count(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>(), '\n'));
+                bytes += std::filesystem::file_size(file.path());
+                files++;
+            }
+
+            return lines == threadsCount * messagesPerThread + errors;
+        }));
+        auto after = LOG_MANAGER->statistics();
+
+        LOG_MANAGER->setLogLevel(logcplus::Logger::LogLevel::Debug);
+        settingsGuard.restore();
+
+        // Old log files are counted by the directory watcher.
+        std::ofstream(logDirectory / "2020-01-01.log.1") << "Old log" << std::endl;
+        std::filesystem::last_write_time(logDirectory / "2020-01-01.log.1", std::filesystem::file_time_type::clock::now() - std::chrono::hours(48));
+        logcplus::DirectoryWatcher watcher;
+        watcher.start(logDirectory.string(), 24 * 60 * 60 * 1000ULL, LOG_FILE_FORMAT, 10);
+        watcher.stop();
+        std::filesystem::remove_all(logDirectory);
+
+        auto level = [](logcplus::LogLevel _level) {
+            return static_cast<std::size_t>(_level);
+        };
+        BOOST_CHECK_EQUAL(after.enqueued[level(logcplus::LogLevel::Info)] - before.enqueued[level(logcplus::LogLevel::Info)], threadsCount * messagesPerThread);
+        BOOST_CHECK_EQUAL(after.enqueued[level(logcplus::LogLevel::Error)] - before.enqueued[level(logcplus::LogLevel::Error)], errors);
+        BOOST_CHECK_EQUAL(after.enqueued[level(logcplus::LogLevel::Debug)], before.enqueued[level(logcplus::LogLevel::Debug)]);
+        BOOST_CHECK_EQUAL(after.written[level(logcplus::LogLevel::Info)] - before.written[level(logcplus::LogLevel::Info)], threadsCount * messagesPerThread);
+        BOOST_CHECK_EQUAL(after.written[level(logcplus::LogLevel::Error)] - before.written[level(logcplus::LogLevel::Error)], errors);
+        BOOST_CHECK_EQUAL(after.bytesWritten - before.bytesWritten, bytes);
+        BOOST_CHECK_EQUAL(after.rotations - before.rotations, files - 1);
+        BOOST_CHECK_EQUAL(after.writeErrors, before.writeErrors);
+        BOOST_CHECK_EQUAL(after.queueDepth, 0u);
+        BOOST_CHECK_EQUAL(watcher.removedFiles(), 1u);
+    }
+
 }
@@ -6,6 +6,18 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+
+#include "logcplus.h"
+
+/*
+ * Heap allocations counter (used by the zero allocation tests, see allocationcounter.cpp). Counts only allocations of
+ * the calling thread and only when counting is enabled.
+ */
+extern thread_local bool COUNT_ALLOCATIONS;
+extern thread_local std::size_t ALLOCATIONS;
 
 namespace dev::marcinromanowski {
 
@@ -34,6 +46,89 @@ namespace dev::marcinromanowski {
         std::streambuf* const saved;
     };
 
+    /**
+     * Restores the log file settings changed by the test (console mode, current directory, unlimited file size, write(2)
+     * backend) and restarts the logger. Restored at the end of the scope (also when the test fails) or earlier on
+     * `restore` (e.g. to close the log file before it's checked).
+     */
+    class LogFileSettingsGuard {
+    public:
+        LogFileSettingsGuard() = default;
+
+        LogFileSettingsGuard(const LogFileSettingsGuard&) = delete;
+
+        ~LogFileSettingsGuard() {
+            restore();
+        }
+
+        void operator=(const LogFileSettingsGuard&) = delete;
+
+        void restore() {
+            if (restored) {
+                return;
+            }
+
+            restored = true;
+            auto logManager = logcplus::LogManager::instance();
+            logManager->setLogMode(logcplus::Logger::LogMode::Console);
+            logManager->setLogDirectory(std::filesystem::current_path());
+            logManager->setMaxFileSize(0, logcplus::filesize_t::SizeUnit::B);
+            logManager->setFileBackend(logcplus::Logger::FileBackend::Write);
+            logManager->initialize();
+        }
+
+    private:
+        bool restored = false;
+    };
+
+    /**
+     * Stream buffer which remembers the time when each line was written (used by latency tests).
+     */
+    class LineTimestampBuffer : public std::streambuf {
+    public:
+        std::size_t lines() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return timestamps.size();
+        }
+
+        std::chrono::steady_clock::time_point lineTimestamp(std::size_t line) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return timestamps.at(line);
+        }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (ch == '\n') {
+                std::lock_guard<std::mutex> lock(mutex);
+                timestamps.push_back(std::chrono::steady_clock::now());
+            }
+
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize count) override {
+            auto now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::streamsize i = 0; i < count; i++) {
+                if (s[i] == '\n') {
+                    timestamps.push_back(now);
+                }
+            }
+
+            return count;
+        }
+
+    private:
+        mutable std::mutex mutex;
+        std::vector<std::chrono::steady_clock::time_point> timestamps;
+    };
+
+    template<typename Duration>
+    Duration percentile(std::vector<Duration> samples, double percent) {
+        std::sort(samples.begin(), samples.end());
+        return samples[static_cast<std::size_t>(percent / 100.0 * (samples.size() - 1))];
+    }
+
     char directorySeparator() {
 #ifdef _WIN32
         return '\\';
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "logcplus.h"
+
+using namespace dev::marcinromanowski::logcplus;
+
+/*
+ * Converts binary logs (see BinaryFileSink) to the text format.
+ *
+ * Usage: logcplusDecoder <binary log> [Seconds / Milliseconds / Microseconds]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <binary log> [Seconds / Milliseconds / Microseconds]" << std::endl;
+        return 1;
+    }
+
+    TimestampCache::Precision precision = TimestampCache::Precision::Seconds;
+    if (argc == 3) {
+        std::string value = argv[2];
+        if (value == "Milliseconds") {
+            precision = TimestampCache::Precision::Milliseconds;
+        } else if (value == "Microseconds") {
+            precision = TimestampCache::Precision::Microseconds;
+        } else if (value != "Seconds") {
+            std::cerr << "Unexpected timestamp precision: " << value << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (!BinaryLogDecoder::decode(input, std::cout, precision)) {
+        std::cerr << "Binary log is truncated or corrupted: " << argv[1] << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
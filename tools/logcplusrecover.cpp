@@ -0,0 +1,75 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <csignal>
+
+#include "logcplus.h"
+
+using namespace dev::marcinromanowski::logcplus;
+
+/*
+ * Appends messages left in the shared memory ring of the dead process (see SharedMemoryRing) to the log file
+ * (YYYY-MM-DD.log) in the log directory. The ring file is removed when all messages are recovered.
+ *
+ * Usage: logcplusRecover <ring file> <log directory> [Seconds / Milliseconds / Microseconds]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <ring file> <log directory> [Seconds / Milliseconds / Microseconds]" << std::endl;
+        return 1;
+    }
+
+    TimestampCache::Precision precision = TimestampCache::Precision::Seconds;
+    if (argc == 4) {
+        std::string value = argv[3];
+        if (value == "Milliseconds") {
+            precision = TimestampCache::Precision::Milliseconds;
+        } else if (value == "Microseconds") {
+            precision = TimestampCache::Precision::Microseconds;
+        } else if (value != "Seconds") {
+            std::cerr << "Unexpected timestamp precision: " << value << std::endl;
+            return 1;
+        }
+    }
+
+    std::filesystem::path ring = argv[1];
+    auto owner = SharedMemoryRing::owner(ring);
+    if (!owner.has_value()) {
+        std::cerr << "Not a shared memory ring: " << ring << std::endl;
+        return 2;
+    }
+
+    // The ring is still used by the running process.
+    if (::kill(owner.value(), 0) == 0 || errno == EPERM) {
+        std::cerr << "Process " << owner.value() << " owning the ring is still running" << std::endl;
+        return 3;
+    }
+
+    std::filesystem::path logDirectory = argv[2];
+    std::error_code errorCode;
+    std::filesystem::create_directories(logDirectory, errorCode);
+
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char filename[32];
+    std::strftime(filename, sizeof(filename), "%Y-%m-%d.log", &local);
+
+    std::ofstream output(logDirectory / filename, std::ios::app);
+    if (!output) {
+        std::cerr << "Cannot open " << logDirectory / filename << std::endl;
+        return 1;
+    }
+
+    auto recovered = SharedMemoryRing::recover(ring, output, precision);
+    output.flush();
+    if (!recovered.has_value() || !output) {
+        std::cerr << "Cannot recover the shared memory ring: " << ring << std::endl;
+        return 2;
+    }
+
+    std::filesystem::remove(ring, errorCode);
+    std::cout << "Recovered " << recovered.value() << " messages to " << (logDirectory / filename).string() << std::endl;
+
+    return 0;
+}